@@ -30,8 +30,10 @@
 
 #include "config.h"
 #include "live/livequeue.h"
+#include "recordings/readahead.h"
+#include "recordings/recplayer.h"
 
-RoboTVServerConfig::RoboTVServerConfig() : listenPort(LISTEN_PORT) {
+RoboTVServerConfig::RoboTVServerConfig() : listenPort(LISTEN_PORT), threadedDemuxer(false) {
 }
 
 void RoboTVServerConfig::Load() {
@@ -57,6 +59,12 @@ bool RoboTVServerConfig::Parse(const char* Name, const char* Value) {
     else if(!strcasecmp(Name, "MaxTimeShiftSize")) {
         LiveQueue::setBufferSize(strtoull(Value, NULL, 10));
     }
+    else if(!strcasecmp(Name, "RecordingReadAhead")) {
+        ReadAhead::setWindowSize(strtoll(Value, NULL, 10));
+    }
+    else if(!strcasecmp(Name, "RecordingDirectIO")) {
+        RecPlayer::setDirectIO(!strcasecmp(Value, "true") || !strcmp(Value, "1"));
+    }
     else if(!strcasecmp(Name, "PiconsURL")) {
         piconsUrl = Value;
     }
@@ -71,6 +79,10 @@ bool RoboTVServerConfig::Parse(const char* Name, const char* Value) {
         isyslog("Folder for TV shows: %s", Value);
         seriesFolder = Value;
     }
+    else if(!strcasecmp(Name, "ThreadedDemuxer")) {
+        threadedDemuxer = (!strcasecmp(Value, "true") || !strcmp(Value, "1"));
+        isyslog("Threaded demuxer: %s", threadedDemuxer ? "enabled" : "disabled");
+    }
     else {
         return false;
     }
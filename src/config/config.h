@@ -66,6 +66,7 @@ public:
     std::string reorderCmd;
     std::string epgImageUrl;
     std::string seriesFolder;
+    bool threadedDemuxer; // demux live streams in one thread per stream
 };
 
 #endif // ROBOTV_CONFIG_H
@@ -0,0 +1,102 @@
+/*
+ *      vdr-plugin-robotv - roboTV server plugin for VDR
+ *
+ *      Copyright (C) 2016 Alexander Pipelka
+ *
+ *      https://github.com/pipelka/vdr-plugin-robotv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#ifndef ROBOTV_BUFFERPOOL_H
+#define ROBOTV_BUFFERPOOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+#include <mutex>
+#include <utility>
+
+/**
+ * Process-wide pool of parser buffers.
+ * Released buffers are kept by size class (size and mirrored / plain) up to
+ * a byte limit and handed out again by the next acquire(). So a channel switch
+ * reuses the buffers (and mappings) of the previous channel instead of
+ * allocating them again.
+ */
+class BufferPool {
+public:
+
+    struct Statistics {
+        uint64_t hits = 0; // buffers taken from the pool
+
+        uint64_t misses = 0; // newly allocated buffers
+
+        size_t buffers = 0; // buffers currently kept in the pool
+
+        size_t bytes = 0; // bytes currently kept in the pool
+
+        size_t used = 0; // buffers currently in use
+    };
+
+    static BufferPool& instance();
+
+    /**
+     * Get a buffer from the pool or allocate a new one.
+     * A mirrored buffer is mapped twice in a row (size bytes each).
+     *
+     * @param size size of the buffer, may be rounded up (page size)
+     * @param mirrored request a mirrored buffer, set to false if the mapping failed
+     * @return pointer to the buffer or nullptr
+     */
+    uint8_t* acquire(int& size, bool& mirrored);
+
+    /**
+     * Return a buffer to the pool.
+     * The buffer will be freed if the pool exceeds its limit.
+     */
+    void release(uint8_t* buffer, int size, bool mirrored);
+
+    // maximum number of bytes kept in the pool
+    void setLimit(size_t bytes);
+
+    // free all pooled buffers
+    void purge();
+
+    Statistics getStatistics();
+
+private:
+
+    BufferPool();
+
+    static uint8_t* allocate(int& size, bool& mirrored);
+
+    static uint8_t* createMirror(int size);
+
+    static void free(uint8_t* buffer, int size, bool mirrored);
+
+    std::mutex m_mutex;
+
+    std::multimap<std::pair<int, bool>, uint8_t*> m_pool;
+
+    size_t m_limit;
+
+    Statistics m_statistics;
+
+};
+
+#endif // ROBOTV_BUFFERPOOL_H
@@ -44,13 +44,26 @@ public:
         int64_t pid;
         int64_t dts;
         int64_t pts;
+        int64_t time = DVD_NOPTS_VALUE; // monotonic time of the DTS (90kHz, set by the DemuxerBundle)
         int64_t streamPosition = 0;
+        int64_t framePosition = 0;
         int duration = 0;
 
         uint8_t* data = nullptr;
         int size = 0;
     };
 
+    struct FrameIndex {
+        StreamInfo::FrameType frameType = StreamInfo::FrameType::UNKNOWN;
+
+        int64_t pid;
+        int64_t position; // stream position of the TS packet the frame starts in (0 if the source has no positions, e.g. live streams)
+        int64_t dts;
+        int64_t pts;
+        int64_t time = DVD_NOPTS_VALUE; // monotonic time of the DTS (90kHz, set by the DemuxerBundle)
+        int size = 0;
+    };
+
     class Listener {
     public:
 
@@ -60,6 +73,9 @@ public:
 
         virtual void onStreamChange() = 0;
 
+        // called for every video frame before the frame is sent (optional)
+        virtual void onFrameIndex(FrameIndex*) {}
+
     };
 
 private:
@@ -76,6 +92,12 @@ public:
 
     TsDemuxer(Listener* streamer, const StreamInfo& info);
 
+    /**
+     * Stream information only (without parser).
+     * Mirrors a demuxer running in a DemuxerWorker thread.
+     */
+    explicit TsDemuxer(const StreamInfo& info);
+
     virtual ~TsDemuxer();
 
     bool processTsPacket(unsigned char* packet) const;
@@ -138,14 +160,40 @@ public:
         m_streamPosition = position;
     }
 
-    /* Decoder specific data */
-    void setVideoDecoderData(uint8_t* sps, size_t spsLength, uint8_t* pps, size_t ppsLength, uint8_t* vps = NULL, size_t vpsLength = 0);
+    inline int64_t getStreamPosition() const {
+        return m_streamPosition;
+    }
 
-    uint8_t* getVideoDecoderSps(int& length);
+    /* Transport stream continuity (maintained by the DemuxerBundle) */
+    inline int getContinuityCounter() const {
+        return m_continuityCounter;
+    }
 
-    uint8_t* getVideoDecoderPps(int& length);
+    inline void setContinuityCounter(int counter) {
+        m_continuityCounter = counter;
+    }
 
-    uint8_t* getVideoDecoderVps(int& length);
+    inline bool hasPendingError() const {
+        return m_pendingError;
+    }
+
+    inline void setPendingError(bool error) {
+        m_pendingError = error;
+    }
+
+    // audio parsers resync on the sync word of the next frame,
+    // PES / NAL assembling parsers need the next payload unit
+    inline bool resyncsOnSyncWord() const {
+        return m_content == Content::AUDIO;
+    }
+
+    inline uint64_t getLostPackets() const {
+        return m_lostPackets;
+    }
+
+    inline void addLostPackets(int count) {
+        m_lostPackets += count;
+    }
 
     void reset();
 
@@ -161,6 +209,12 @@ private:
 
     int64_t m_streamPosition;
 
+    int m_continuityCounter = -1;
+
+    bool m_pendingError = false;
+
+    uint64_t m_lostPackets = 0;
+
     Parser* createParser(StreamInfo::Type type);
 
 };
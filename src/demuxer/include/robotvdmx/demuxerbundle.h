@@ -27,10 +27,19 @@
 
 #include "demuxer.h"
 #include "streambundle.h"
+#include "timeline.h"
 
 #include <list>
+#include <map>
 
-class DemuxerBundle {
+class DemuxerWorker;
+
+/**
+ * Demuxers of a channel.
+ * Stream packets are passed to the listener with their time on the
+ * channel timeline (StreamPacket::time).
+ */
+class DemuxerBundle : public TsDemuxer::Listener {
 public:
 
     explicit DemuxerBundle(TsDemuxer::Listener* listener);
@@ -45,10 +54,49 @@ public:
 
     bool isReady() const;
 
+    /**
+     * Update the demuxers from a stream bundle.
+     * Demuxers of unchanged streams (same PID and type) keep running,
+     * only added or changed streams get a new demuxer.
+     */
     void updateFrom(StreamBundle* bundle);
 
     bool processTsPacket(uint8_t* packet, int64_t streamPosition);
 
+    void flush();
+
+    /**
+     * Wait until the stream threads processed all queued TS packets.
+     * Packets are dropped if a stream thread doesn't keep up, a source
+     * faster than realtime (e.g. a file) has to wait from time to time.
+     */
+    void drain();
+
+    /**
+     * Enable / disable the demuxing of a stream.
+     * Disabled streams are only demuxed until their stream information
+     * is known (so they can be announced), their packets are dropped.
+     * An enabled stream starts with the next payload unit.
+     */
+    bool setEnabled(int pid, bool enabled);
+
+    // number of packets lost on all streams (continuity counter)
+    uint64_t getLostPackets() const;
+
+    /**
+     * Run every stream demuxer in its own thread.
+     * Stream packets are merged in DTS order and delivered to the listener
+     * from the thread calling processTsPacket(). Only affects demuxers created
+     * by a subsequent call to updateFrom().
+     */
+    void setThreaded(bool threaded) {
+        m_threaded = threaded;
+    }
+
+    bool isThreaded() const {
+        return m_threaded;
+    }
+
     std::list<TsDemuxer*>::iterator begin() {
         return m_list.begin();
     }
@@ -63,16 +111,40 @@ public:
 
 protected:
 
-    void reset();
+    void onStreamPacket(TsDemuxer::StreamPacket* p);
+
+    void onStreamChange();
+
+    void onFrameIndex(TsDemuxer::FrameIndex* index);
 
     TsDemuxer::Listener* m_listener = NULL;
 
 private:
 
-    bool m_pendingError;
+    void deliverPackets(bool all);
+
+    void resetDemuxer(TsDemuxer* demuxer);
+
+    TsDemuxer* createDemuxer(const StreamInfo& info);
+
+    void removeDemuxer(TsDemuxer* demuxer);
+
+    bool isEnabled(int pid) const;
+
+    bool checkContinuity(TsDemuxer* demuxer, const uint8_t* packet);
+
+    void setError(TsDemuxer* demuxer);
+
+    bool m_threaded = false;
+
+    Timeline m_timeline;
+
+    int m_referencePid = 0;
 
     std::list<TsDemuxer*> m_list;
 
+    std::map<int, DemuxerWorker*> m_workers;
+
 };
 
 #endif // ROBOTV_DEMUXERBUNDLE_H
@@ -112,6 +112,8 @@ inline int64_t PesGetDts(const uint8_t *p)
 #define TS_ERROR              0x80
 #define TS_PAYLOAD_EXISTS     0x10
 #define TS_PID_MASK_HI        0x1F
+#define TS_CONT_CNT_MASK      0x0F
+#define TS_DISCONTINUITY      0x80
 
 
 // TS Helper Functions
@@ -145,5 +147,15 @@ inline int TsPid(const uint8_t *p) {
     return (p[1] & TS_PID_MASK_HI) * 256 + p[2];
 }
 
+inline int TsContinuityCounter(const uint8_t* p)
+{
+    return p[3] & TS_CONT_CNT_MASK;
+}
+
+inline bool TsDiscontinuity(const uint8_t* p)
+{
+    return TsHasAdaptationField(p) && p[4] > 0 && (p[5] & TS_DISCONTINUITY);
+}
+
 #endif // ROBOTV_PES_H
 
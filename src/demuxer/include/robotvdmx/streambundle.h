@@ -35,6 +35,8 @@ public:
 
     void addStream(const StreamInfo& s);
 
+    void addStream(StreamInfo&& s);
+
     bool operator ==(const StreamBundle& c) const;
 
     bool isMetaOf(const StreamBundle& c) const;
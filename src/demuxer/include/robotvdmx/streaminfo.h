@@ -27,12 +27,13 @@
 
 #include <stdint.h>
 #include <fstream>
+#include <memory>
 #include <string>
 
 class StreamInfo {
 public:
 
-    enum class Content {
+    enum class Content : uint8_t {
         NONE,
         VIDEO,
         AUDIO,
@@ -41,7 +42,7 @@ public:
         STREAMINFO
     };
 
-    enum class Type {
+    enum class Type : uint8_t {
         NONE,
         MPEG2AUDIO,
         AC3,
@@ -55,7 +56,7 @@ public:
         H265
     };
 
-    enum class FrameType {
+    enum class FrameType : uint8_t {
         UNKNOWN,
         IFRAME,
         PFRAME,
@@ -69,8 +70,16 @@ public:
 
     StreamInfo(int pid, Type type, const char* lang = nullptr);
 
+    StreamInfo(const StreamInfo& rhs) = default;
+
+    StreamInfo(StreamInfo&& rhs) = default;
+
     virtual ~StreamInfo() = default;
 
+    StreamInfo& operator=(const StreamInfo& rhs) = default;
+
+    StreamInfo& operator=(StreamInfo&& rhs) = default;
+
     bool operator ==(const StreamInfo& rhs) const;
 
     bool isMetaOf(const StreamInfo& rhs) const;
@@ -109,52 +118,79 @@ public:
         return m_enabled;
     }
 
+    inline void setEnabled(bool enabled) {
+        m_enabled = enabled;
+    }
+
     void setSubtitlingDescriptor(unsigned char SubtitlingType, uint16_t CompositionPageId, uint16_t AncillaryPageId);
 
+    // take over the descriptor data (language, subtitling) of an updated stream
+    void updateMetaData(const StreamInfo& info);
+
+    // take over the stream data found by the parser (video / audio properties, decoder data)
+    void updateStreamData(const StreamInfo& info);
+
+    /* Decoder specific data */
+    void setVideoDecoderData(const uint8_t* sps, size_t spsLength, const uint8_t* pps, size_t ppsLength, const uint8_t* vps = NULL, size_t vpsLength = 0);
+
+    const uint8_t* getVideoDecoderSps(int& length) const;
+
+    const uint8_t* getVideoDecoderPps(int& length) const;
+
+    const uint8_t* getVideoDecoderVps(int& length) const;
+
+    inline bool sharesDecoderData(const StreamInfo& info) const {
+        return m_decoderData == info.m_decoderData;
+    }
+
 protected:
 
+    // parameter sets of video streams (shared between copies, copy-on-write)
+    struct DecoderData {
+        uint8_t sps[128]; // SPS data (for decoder)
+        uint8_t pps[128]; // PPS data (for decoder)
+        uint8_t vps[128]; // VPS data (for decoder)
+
+        uint8_t spsLength = 0; // SPS length
+        uint8_t ppsLength = 0; // PPS length
+        uint8_t vpsLength = 0; // VPS length
+    };
+
     Content m_content; // stream content (e.g. scVIDEO)
 
     Type m_type; // stream type (e.g. stAC3)
 
-    int m_pid; // transport stream pid
+    uint8_t m_channels; // number of audio channels (e.g. 6 for 5.1)
 
-    char m_language[4]; // ISO 639 3-letter language code (empty string if undefined)
+    unsigned char m_subTitlingType; // subtitling type
 
-    int m_fpsScale; // scale of 1000 and a rate of 29970 will result in 29.97 fps
+    char m_language[4]; // ISO 639 3-letter language code (empty string if undefined)
 
-    int m_fpsRate;
+    int m_pid; // transport stream pid
 
     uint16_t m_height; // height of the stream reported by the demuxer
 
     uint16_t m_width; // width of the stream reported by the demuxer
 
-    int m_aspect; // display aspect of stream (*10000 : 1,7777 = 17777)
+    int m_fpsScale; // scale of 1000 and a rate of 29970 will result in 29.97 fps
 
-    uint8_t m_channels; // number of audio channels (e.g. 6 for 5.1)
+    int m_fpsRate;
+
+    int m_aspect; // display aspect of stream (*10000 : 1,7777 = 17777)
 
     uint32_t m_sampleRate; // number of audio samples per second (e.g. 48000)
 
     uint32_t m_bitRate; // audio bitrate (e.g. 160000)
 
-    bool m_parsed; // stream parsed flag (if all stream data is known)
-
-    unsigned char m_subTitlingType; // subtitling type
-
     uint16_t m_compositionPageId; // composition page id
 
     uint16_t m_ancillaryPageId; // ancillary page id
 
-    // decoder data
-    uint8_t m_sps[128]; // SPS data (for decoder)
-    uint8_t m_pps[128]; // PPS data (for decoder)
-    uint8_t m_vps[128]; // VPS data (for decoder)
+    bool m_parsed; // stream parsed flag (if all stream data is known)
 
-    size_t m_spsLength; // SPS length
-    size_t m_ppsLength; // PPS length
-    size_t m_vpsLength; // VPS length
+    bool m_enabled = true; // stream selected (disabled streams are only demuxed until parsed)
 
-    bool m_enabled = false;
+    std::shared_ptr<const DecoderData> m_decoderData; // decoder data (video only)
 
     friend class ChannelCache;
 
@@ -0,0 +1,71 @@
+/*
+ *      vdr-plugin-robotv - roboTV server plugin for VDR
+ *
+ *      Copyright (C) 2016 Alexander Pipelka
+ *
+ *      https://github.com/pipelka/vdr-plugin-robotv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#ifndef ROBOTV_TIMELINE_H
+#define ROBOTV_TIMELINE_H
+
+#include <stdint.h>
+
+/**
+ * Monotonic stream timeline.
+ * Unwraps the 33 bit timestamps (90kHz) of a channel into a 64 bit timeline.
+ * The timeline follows the timestamps of a reference stream (video DTS),
+ * jumps of the reference stream (discontinuities) are removed, so the
+ * timeline continues where it left off. Timestamps of the other streams are
+ * mapped relative to the last reference timestamp.
+ * Without any discontinuity the time equals the unwrapped timestamp.
+ */
+class Timeline {
+public:
+
+    Timeline();
+
+    void reset();
+
+    /**
+     * Map a 33 bit timestamp onto the timeline
+     *
+     * @param ts timestamp (90kHz)
+     * @param reference timestamp of the reference stream
+     * @return time (90kHz) or DVD_NOPTS_VALUE
+     */
+    int64_t stamp(int64_t ts, bool reference);
+
+    /**
+     * Signed difference of two 33 bit timestamps (a - b)
+     */
+    static inline int64_t difference(int64_t a, int64_t b) {
+        int64_t d = (a - b) & 0x1FFFFFFFFLL;
+        return (d > 0xFFFFFFFFLL) ? d - 0x200000000LL : d;
+    }
+
+private:
+
+    int64_t m_lastTs;
+
+    int64_t m_lastTime;
+
+};
+
+#endif // ROBOTV_TIMELINE_H
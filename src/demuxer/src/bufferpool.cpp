@@ -0,0 +1,184 @@
+/*
+ *      vdr-plugin-robotv - roboTV server plugin for VDR
+ *
+ *      Copyright (C) 2016 Alexander Pipelka
+ *
+ *      https://github.com/pipelka/vdr-plugin-robotv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "robotvdmx/bufferpool.h"
+
+// default limit of the pooled buffers
+#define BUFFERPOOL_LIMIT (16 * 1024 * 1024)
+
+BufferPool::BufferPool() : m_limit(BUFFERPOOL_LIMIT) {
+}
+
+BufferPool& BufferPool::instance() {
+    // never destroyed, buffers may be released during static destruction
+    static BufferPool* pool = new BufferPool;
+    return *pool;
+}
+
+uint8_t* BufferPool::acquire(int& size, bool& mirrored) {
+    if(mirrored) {
+        long pageSize = sysconf(_SC_PAGESIZE);
+
+        if(pageSize > 0) {
+            size = (int)(((size + pageSize - 1) / pageSize) * pageSize);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto i = m_pool.find(std::make_pair(size, mirrored));
+
+        if(i != m_pool.end()) {
+            uint8_t* buffer = i->second;
+            m_pool.erase(i);
+
+            m_statistics.hits++;
+            m_statistics.buffers--;
+            m_statistics.bytes -= size;
+            m_statistics.used++;
+
+            return buffer;
+        }
+    }
+
+    uint8_t* buffer = allocate(size, mirrored);
+
+    if(buffer == nullptr) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_statistics.misses++;
+    m_statistics.used++;
+
+    return buffer;
+}
+
+void BufferPool::release(uint8_t* buffer, int size, bool mirrored) {
+    if(buffer == nullptr) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_statistics.used--;
+
+        if(m_statistics.bytes + size <= m_limit) {
+            m_pool.insert(std::make_pair(std::make_pair(size, mirrored), buffer));
+            m_statistics.buffers++;
+            m_statistics.bytes += size;
+            return;
+        }
+    }
+
+    free(buffer, size, mirrored);
+}
+
+void BufferPool::setLimit(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_limit = bytes;
+}
+
+void BufferPool::purge() {
+    std::multimap<std::pair<int, bool>, uint8_t*> pool;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        pool.swap(m_pool);
+        m_statistics.buffers = 0;
+        m_statistics.bytes = 0;
+    }
+
+    for(auto& i : pool) {
+        free(i.second, i.first.first, i.first.second);
+    }
+}
+
+BufferPool::Statistics BufferPool::getStatistics() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_statistics;
+}
+
+uint8_t* BufferPool::allocate(int& size, bool& mirrored) {
+    if(mirrored) {
+        uint8_t* buffer = createMirror(size);
+
+        if(buffer != nullptr) {
+            return buffer;
+        }
+
+        mirrored = false;
+    }
+
+    return (uint8_t*)malloc((size_t)size);
+}
+
+uint8_t* BufferPool::createMirror(int size) {
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+    int fd = memfd_create("robotvdmx", MFD_CLOEXEC);
+
+    if(fd == -1) {
+        return nullptr;
+    }
+
+    if(ftruncate(fd, size) == -1) {
+        close(fd);
+        return nullptr;
+    }
+
+    // reserve address space for both mappings
+    uint8_t* buffer = (uint8_t*)mmap(NULL, 2 * (size_t)size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if(buffer == MAP_FAILED) {
+        close(fd);
+        return nullptr;
+    }
+
+    // map the file twice in a row
+    if(mmap(buffer, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+            mmap(buffer + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(buffer, 2 * (size_t)size);
+        close(fd);
+        return nullptr;
+    }
+
+    close(fd);
+    return buffer;
+#else
+    return nullptr;
+#endif
+}
+
+void BufferPool::free(uint8_t* buffer, int size, bool mirrored) {
+    if(mirrored) {
+        munmap(buffer, 2 * (size_t)size);
+        return;
+    }
+
+    ::free(buffer);
+}
@@ -37,8 +37,6 @@
 #include "parsers/parser_mpegvideo.h"
 #include "parsers/parser_subtitle.h"
 
-#define DVD_TIME_BASE 1000000
-
 TsDemuxer::TsDemuxer(TsDemuxer::Listener* streamer, const StreamInfo& info) : StreamInfo(info), m_streamer(streamer) {
     m_pesParser = createParser(m_type);
 
@@ -49,6 +47,9 @@ TsDemuxer::TsDemuxer(TsDemuxer::Listener* streamer, StreamInfo::Type type, int p
     m_pesParser = createParser(m_type);
 }
 
+TsDemuxer::TsDemuxer(const StreamInfo& info) : StreamInfo(info), m_streamer(nullptr), m_pesParser(nullptr) {
+}
+
 Parser* TsDemuxer::createParser(StreamInfo::Type type) {
     switch(type) {
         case Type::MPEG2VIDEO:
@@ -94,10 +95,8 @@ TsDemuxer::~TsDemuxer() {
 }
 
 int64_t TsDemuxer::rescale(int64_t a) {
-    uint64_t b = DVD_TIME_BASE;
-    uint64_t c = 90000;
-
-    return (a * b) / c;
+    // 90kHz -> 1MHz
+    return (a * 100) / 9;
 }
 
 void TsDemuxer::sendPacket(StreamPacket* pkt) {
@@ -107,10 +106,27 @@ void TsDemuxer::sendPacket(StreamPacket* pkt) {
     pkt->duration = (int)rescale(pkt->duration);
     pkt->streamPosition = m_streamPosition;
 
+    // frame index
+    if(m_content == Content::VIDEO) {
+        FrameIndex index;
+        index.frameType = pkt->frameType;
+        index.pid = pkt->pid;
+        index.position = pkt->framePosition;
+        index.dts = pkt->dts;
+        index.pts = pkt->pts;
+        index.size = pkt->size;
+
+        m_streamer->onFrameIndex(&index);
+    }
+
     m_streamer->onStreamPacket(pkt);
 }
 
 bool TsDemuxer::processTsPacket(unsigned char* packet) const {
+    if(m_pesParser == nullptr) {
+        return false;
+    }
+
     bool pusi = TsPayloadStart(packet);
     int offset = TsPayloadOffset(packet);
 
@@ -159,42 +175,14 @@ void TsDemuxer::setAudioInformation(uint8_t channels, uint32_t sampleRate, uint3
     m_streamer->onStreamChange();
 }
 
-void TsDemuxer::setVideoDecoderData(uint8_t* sps, size_t spsLength, uint8_t* pps, size_t ppsLength, uint8_t* vps, size_t vpsLength) {
-    if(sps != NULL && spsLength <= sizeof(m_sps)) {
-        m_spsLength = spsLength;
-        memcpy(m_sps, sps, spsLength);
-    }
-
-    if(pps != NULL && ppsLength <= sizeof(m_pps)) {
-        m_ppsLength = ppsLength;
-        memcpy(m_pps, pps, ppsLength);
-    }
-
-    if(vps != NULL && vpsLength <= sizeof(m_vps)) {
-        m_vpsLength = vpsLength;
-        memcpy(m_vps, vps, vpsLength);
-    }
-}
-
-uint8_t* TsDemuxer::getVideoDecoderSps(int& length) {
-    length = m_spsLength;
-    return m_spsLength == 0 ? NULL : m_sps;
-}
-
-uint8_t* TsDemuxer::getVideoDecoderPps(int& length) {
-    length = m_ppsLength;
-    return m_ppsLength == 0 ? NULL : m_pps;
-}
-
-uint8_t* TsDemuxer::getVideoDecoderVps(int& length) {
-    length = m_vpsLength;
-    return m_vpsLength == 0 ? NULL : m_vps;
-}
-
 void TsDemuxer::reset() {
-    m_pesParser->reset();
+    if(m_pesParser != nullptr) {
+        m_pesParser->reset();
+    }
 }
 
 void TsDemuxer::flush() {
-    m_pesParser->flush();
+    if(m_pesParser != nullptr) {
+        m_pesParser->flush();
+    }
 }
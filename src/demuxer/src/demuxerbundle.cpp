@@ -23,13 +23,21 @@
  */
 
 #include <cstring>
+#include <chrono>
+#include <thread>
 #include <unordered_map>
 
 #include "robotvdmx/demuxerbundle.h"
 #include "robotvdmx/pes.h"
+#include "demuxerworker.h"
+
+// maximum number of packets held back by a stream while merging
+#define MAX_PENDING_PACKETS 64
+
+// don't wait for a stream without packets for more than 2 seconds (90kHz)
+#define MAX_DTS_GAP (2 * 90000)
 
 DemuxerBundle::DemuxerBundle(TsDemuxer::Listener* listener) : m_listener(listener) {
-    m_pendingError = false;
 }
 
 DemuxerBundle::~DemuxerBundle() {
@@ -39,10 +47,14 @@ DemuxerBundle::~DemuxerBundle() {
 
 void DemuxerBundle::clear() {
     for (auto &i : m_list) {
-        delete i;
+        removeDemuxer(i);
     }
 
+    m_workers.clear();
     m_list.clear();
+
+    m_timeline.reset();
+    m_referencePid = 0;
 }
 
 TsDemuxer* DemuxerBundle::findDemuxer(int Pid) const {
@@ -145,36 +157,146 @@ bool DemuxerBundle::isReady() const {
         return false;
     }
 
+    bool hasVideo = false;
+    bool hasAudio = false;
+    bool videoParsed = false;
+    bool audioParsed = false;
+    bool allParsed = true;
+
     for (auto i : m_list) {
-        if(!i->isParsed()) {
-            return false;
+        allParsed &= i->isParsed();
+
+        switch(i->getContent()) {
+            case StreamInfo::Content::VIDEO:
+                hasVideo = true;
+                videoParsed |= i->isParsed();
+                break;
+
+            case StreamInfo::Content::AUDIO:
+                // the first audio stream (in list order) is the primary one
+                if(!hasAudio) {
+                    audioParsed = i->isParsed();
+                }
+
+                hasAudio = true;
+                break;
+
+            default:
+                break;
         }
     }
 
-    return true;
+    // no audio / video (e.g. radio data) - wait for all streams
+    if(!hasVideo && !hasAudio) {
+        return allParsed;
+    }
+
+    // we are ready as soon as the video stream and the first audio stream
+    // are known (or trusted from the cache). Other streams (more audio tracks,
+    // subtitles, ...) will be announced with a stream change when they are parsed.
+    return (!hasVideo || videoParsed) && (!hasAudio || audioParsed);
 }
 
 void DemuxerBundle::updateFrom(StreamBundle* bundle) {
-    // remove old demuxers
-    clear();
+    std::list<TsDemuxer*> list;
 
-    // create new stream demuxers
     for (auto &i : *bundle) {
         StreamInfo& info = i.second;
-        auto dmx = new TsDemuxer(m_listener, info);
+        TsDemuxer* demuxer = findDemuxer(info.getPid());
+
+        // keep unchanged streams (with their parser state)
+        if(demuxer != nullptr && demuxer->getType() == info.getType() && (m_workers.count(info.getPid()) != 0) == m_threaded) {
+            demuxer->updateMetaData(info);
+            m_list.remove(demuxer);
+            list.push_back(demuxer);
+            continue;
+        }
+
+        // create new stream demuxer
+        list.push_back(createDemuxer(info));
+    }
+
+    // remove old demuxers
+    for(auto i : m_list) {
+        removeDemuxer(i);
+    }
+
+    m_list = list;
+
+    // the video stream (or the first audio stream) drives the timeline
+    m_referencePid = 0;
+
+    for(auto i : m_list) {
+        if(i->getContent() == StreamInfo::Content::VIDEO) {
+            m_referencePid = i->getPid();
+            break;
+        }
+
+        if(i->getContent() == StreamInfo::Content::AUDIO && m_referencePid == 0) {
+            m_referencePid = i->getPid();
+        }
+    }
+}
+
+TsDemuxer* DemuxerBundle::createDemuxer(const StreamInfo& info) {
+    // replaced stream
+    TsDemuxer* old = findDemuxer(info.getPid());
+
+    if(old != nullptr) {
+        m_list.remove(old);
+        removeDemuxer(old);
+    }
+
+    if(!m_threaded) {
+        return new TsDemuxer(this, info);
+    }
+
+    // video streams need a larger input queue
+    size_t queueSize = (StreamInfo::getContent(info.getType()) == StreamInfo::Content::VIDEO) ? 4096 : 512;
 
-        m_list.push_back(dmx);
+    DemuxerWorker* worker = new DemuxerWorker(info, queueSize);
+    m_workers[info.getPid()] = worker;
+
+    // the bundle keeps a copy of the stream information,
+    // which is updated from the worker output
+    TsDemuxer* demuxer = new TsDemuxer(worker->getInfo());
+
+    worker->start();
+    return demuxer;
+}
+
+void DemuxerBundle::removeDemuxer(TsDemuxer* demuxer) {
+    auto w = m_workers.find(demuxer->getPid());
+
+    // stop the worker of the stream
+    if(w != m_workers.end()) {
+        delete w->second;
+        m_workers.erase(w);
     }
+
+    delete demuxer;
 }
 
 bool DemuxerBundle::processTsPacket(uint8_t* packet, int64_t streamPosition) {
+    // lost sync - we don't know which streams are affected
     if(*packet != 0x47) {
-        m_pendingError = true;
+        for(auto i: m_list) {
+            setError(i);
+        }
+
+        return false;
+    }
+
+    int pid = TsPid(packet);
+    TsDemuxer* demuxer = findDemuxer(pid);
+
+    // not selected (disabled streams are demuxed until their stream information is known)
+    if(demuxer == nullptr || (!demuxer->isEnabled() && demuxer->isParsed())) {
         return false;
     }
 
     if(TsError(packet) || TsIsScrambled(packet)) {
-        m_pendingError = true;
+        setError(demuxer);
         return false;
     }
 
@@ -182,10 +304,8 @@ bool DemuxerBundle::processTsPacket(uint8_t* packet, int64_t streamPosition) {
         return false;
     }
 
-    int pid = TsPid(packet);
-    TsDemuxer* demuxer = findDemuxer(pid);
-
-    if(demuxer == nullptr) {
+    // duplicate packet
+    if(!checkContinuity(demuxer, packet)) {
         return false;
     }
 
@@ -199,25 +319,282 @@ bool DemuxerBundle::processTsPacket(uint8_t* packet, int64_t streamPosition) {
 
     // valid packet ?
     if(pusi && !PesIsHeader(&packet[offset])) {
-        m_pendingError = true;
+        setError(demuxer);
+        return false;
+    }
+
+    // resync the affected stream on the next payload unit
+    if(demuxer->hasPendingError()) {
+        if(!pusi) {
+            return false;
+        }
+
+        resetDemuxer(demuxer);
+        demuxer->setPendingError(false);
+    }
+
+    if(!m_threaded) {
+        demuxer->setStreamPosition(streamPosition);
+        return demuxer->processTsPacket(packet);
+    }
+
+    auto w = m_workers.find(pid);
+
+    if(w == m_workers.end()) {
         return false;
     }
 
-    if(m_pendingError && pusi) {
-        reset();
-        m_pendingError = false;
+    bool put = w->second->put(packet, streamPosition);
+
+    // the worker doesn't keep up - drop the packet and resync the stream
+    if(!put) {
+        demuxer->addLostPackets(1);
+        setError(demuxer);
     }
 
-    if(m_pendingError) {
+    deliverPackets(false);
+    return put;
+}
+
+bool DemuxerBundle::checkContinuity(TsDemuxer* demuxer, const uint8_t* packet) {
+    int counter = TsContinuityCounter(packet);
+    int last = demuxer->getContinuityCounter();
+
+    demuxer->setContinuityCounter(counter);
+
+    // first packet or signalled discontinuity
+    if(last == -1 || TsDiscontinuity(packet)) {
+        return true;
+    }
+
+    // duplicate packet (may be sent once)
+    if(counter == last) {
         return false;
     }
 
-    demuxer->setStreamPosition(streamPosition);
-    return demuxer->processTsPacket(packet);
+    int expected = (last + 1) & TS_CONT_CNT_MASK;
+
+    // packets lost
+    if(counter != expected) {
+        demuxer->addLostPackets((counter - expected) & TS_CONT_CNT_MASK);
+        setError(demuxer);
+    }
+
+    return true;
 }
 
-void DemuxerBundle::reset() {
+void DemuxerBundle::setError(TsDemuxer* demuxer) {
+    // the parser drops the damaged frame and continues with the next sync word
+    if(demuxer->resyncsOnSyncWord()) {
+        return;
+    }
+
+    // resync on the next payload unit
+    demuxer->setPendingError(true);
+}
+
+bool DemuxerBundle::setEnabled(int pid, bool enabled) {
+    TsDemuxer* demuxer = findDemuxer(pid);
+
+    if(demuxer == nullptr) {
+        return false;
+    }
+
+    if(demuxer->isEnabled() == enabled) {
+        return true;
+    }
+
+    demuxer->setEnabled(enabled);
+
+    // resync on the next payload unit
+    if(enabled) {
+        demuxer->setContinuityCounter(-1);
+        demuxer->setPendingError(true);
+    }
+
+    return true;
+}
+
+uint64_t DemuxerBundle::getLostPackets() const {
+    uint64_t count = 0;
+
     for(auto i: m_list) {
-        i->reset();
+        count += i->getLostPackets();
+    }
+
+    return count;
+}
+
+void DemuxerBundle::resetDemuxer(TsDemuxer* demuxer) {
+    auto w = m_workers.find(demuxer->getPid());
+
+    if(w != m_workers.end()) {
+        w->second->reset();
+        return;
     }
+
+    demuxer->reset();
+}
+
+void DemuxerBundle::flush() {
+    if(m_workers.empty()) {
+        for(auto i: m_list) {
+            i->flush();
+        }
+
+        return;
+    }
+
+    for(auto& w: m_workers) {
+        w.second->flush();
+    }
+
+    // wait until all workers are done (and keep their output queues moving)
+    for(;;) {
+        deliverPackets(true);
+
+        bool flushed = true;
+
+        for(auto& w: m_workers) {
+            flushed &= w.second->isFlushed();
+        }
+
+        if(flushed) {
+            break;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    deliverPackets(true);
+}
+
+void DemuxerBundle::drain() {
+    for(;;) {
+        deliverPackets(false);
+
+        bool idle = true;
+
+        for(auto& w: m_workers) {
+            idle &= w.second->isIdle();
+        }
+
+        if(idle) {
+            break;
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+static inline bool isBefore(int64_t a, int64_t b) {
+    return ((a - b) & MAX33BIT) > (MAX33BIT >> 1);
+}
+
+void DemuxerBundle::deliverPackets(bool all) {
+    for(;;) {
+        DemuxerWorker* next = nullptr;
+        bool waiting = false;
+        int64_t waitingDts = DVD_NOPTS_VALUE;
+
+        for(auto& i: m_workers) {
+            DemuxerWorker* w = i.second;
+            DemuxerWorker::Output* o = w->front();
+
+            // an active (enabled) audio / video stream without packets may still
+            // deliver an earlier packet
+            if(o == nullptr) {
+                if(!w->isActive() || !isEnabled(i.first)) {
+                    continue;
+                }
+
+                // newest DTS of the streams we are waiting for (unknown DTS: wait)
+                int64_t dts = w->getLastDts();
+
+                if(!waiting || (waitingDts != DVD_NOPTS_VALUE && (dts == DVD_NOPTS_VALUE || isBefore(waitingDts, dts)))) {
+                    waitingDts = dts;
+                }
+
+                waiting = true;
+                continue;
+            }
+
+            // stream changes and packets without timestamp go first
+            if(o->hasInfo || o->packet.dts == DVD_NOPTS_VALUE) {
+                next = w;
+                waiting = false;
+                break;
+            }
+
+            if(next == nullptr || isBefore(o->packet.dts, next->front()->packet.dts)) {
+                next = w;
+            }
+        }
+
+        if(next == nullptr) {
+            return;
+        }
+
+        // the streams we are waiting for didn't deliver packets for too long
+        if(waiting && waitingDts != DVD_NOPTS_VALUE) {
+            waiting = !isBefore(PtsAdd(waitingDts, MAX_DTS_GAP), next->front()->packet.dts);
+        }
+
+        // wait for the other streams unless we hold back too many packets
+        if(waiting && !all && next->pending() < MAX_PENDING_PACKETS) {
+            return;
+        }
+
+        DemuxerWorker::Output* o = next->front();
+
+        if(o->hasInfo) {
+            TsDemuxer* demuxer = findDemuxer(o->info.getPid());
+
+            if(demuxer != nullptr) {
+                demuxer->updateStreamData(o->info);
+            }
+
+            if(o->streamChange) {
+                onStreamChange();
+            }
+        }
+        else {
+            if(o->hasIndex) {
+                onFrameIndex(&o->index);
+            }
+
+            o->packet.data = o->data.data();
+            onStreamPacket(&o->packet);
+        }
+
+        next->pop();
+        delete o;
+    }
+}
+
+bool DemuxerBundle::isEnabled(int pid) const {
+    TsDemuxer* demuxer = findDemuxer(pid);
+    return (demuxer != nullptr && demuxer->isEnabled());
+}
+
+void DemuxerBundle::onStreamPacket(TsDemuxer::StreamPacket* p) {
+    if(!isEnabled((int)p->pid)) {
+        return;
+    }
+
+    p->time = m_timeline.stamp(p->dts, p->pid == m_referencePid);
+    m_listener->onStreamPacket(p);
+}
+
+void DemuxerBundle::onStreamChange() {
+    m_listener->onStreamChange();
+}
+
+void DemuxerBundle::onFrameIndex(TsDemuxer::FrameIndex* index) {
+    if(!isEnabled((int)index->pid)) {
+        return;
+    }
+
+    index->time = m_timeline.stamp(index->dts, index->pid == m_referencePid);
+    m_listener->onFrameIndex(index);
 }
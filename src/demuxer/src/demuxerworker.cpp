@@ -0,0 +1,212 @@
+/*
+ *      vdr-plugin-robotv - roboTV server plugin for VDR
+ *
+ *      Copyright (C) 2016 Alexander Pipelka
+ *
+ *      https://github.com/pipelka/vdr-plugin-robotv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <chrono>
+#include <cstring>
+
+#include "demuxerworker.h"
+
+DemuxerWorker::DemuxerWorker(const StreamInfo& info, size_t queueSize) :
+    m_input(queueSize), m_output(256),
+    m_running(false), m_sleeping(false), m_flushed(false), m_active(false) {
+    m_demuxer = new TsDemuxer(this, info);
+    m_info = *m_demuxer;
+}
+
+DemuxerWorker::~DemuxerWorker() {
+    stop();
+
+    // discard undelivered packets
+    Output* p = nullptr;
+
+    while((p = front()) != nullptr) {
+        delete p;
+        pop();
+    }
+
+    delete m_demuxer;
+}
+
+void DemuxerWorker::start() {
+    if(m_running) {
+        return;
+    }
+
+    m_running = true;
+    m_thread = std::thread(&DemuxerWorker::action, this);
+}
+
+void DemuxerWorker::stop() {
+    if(!m_running) {
+        return;
+    }
+
+    m_running = false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cond.notify_one();
+    }
+
+    m_thread.join();
+}
+
+bool DemuxerWorker::queue(const Input& input) {
+    if(!m_input.push(input)) {
+        return false;
+    }
+
+    // wakeup worker
+    if(m_sleeping) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cond.notify_one();
+    }
+
+    return true;
+}
+
+bool DemuxerWorker::put(const uint8_t* packet, int64_t streamPosition) {
+    Input input;
+    input.command = Command::PACKET;
+    input.streamPosition = streamPosition;
+    memcpy(input.data, packet, TS_SIZE);
+
+    return queue(input);
+}
+
+void DemuxerWorker::reset() {
+    Input input;
+    input.command = Command::RESET;
+
+    while(!queue(input)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void DemuxerWorker::flush() {
+    Input input;
+    input.command = Command::FLUSH;
+
+    m_flushed = false;
+
+    while(!queue(input)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void DemuxerWorker::action() {
+    while(m_running) {
+        Input* input = m_input.front();
+
+        // wait for data
+        if(input == nullptr) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_sleeping = true;
+
+            if(m_input.empty() && m_running) {
+                m_cond.wait_for(lock, std::chrono::milliseconds(10));
+            }
+
+            m_sleeping = false;
+            continue;
+        }
+
+        switch(input->command) {
+            case Command::PACKET:
+                m_demuxer->setStreamPosition(input->streamPosition);
+                m_demuxer->processTsPacket(input->data);
+                break;
+
+            case Command::RESET:
+                m_demuxer->reset();
+                m_active = false;
+                break;
+
+            case Command::FLUSH:
+                m_demuxer->flush();
+                m_flushed = true;
+                break;
+        }
+
+        m_input.pop();
+    }
+}
+
+void DemuxerWorker::output(Output* p) {
+    // wait for the consumer if the output queue is full
+    while(!m_output.push(p)) {
+        if(!m_running) {
+            delete p;
+            return;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void DemuxerWorker::onStreamPacket(TsDemuxer::StreamPacket* p) {
+    // parameter sets changed without a stream change
+    if(!m_demuxer->sharesDecoderData(m_info)) {
+        publishInfo(false);
+    }
+
+    Output* o = new Output;
+    o->packet = *p;
+    o->data.assign(p->data, p->data + p->size);
+    o->packet.data = nullptr;
+
+    if(m_hasIndex) {
+        o->hasIndex = true;
+        o->index = m_index;
+        m_hasIndex = false;
+    }
+
+    StreamInfo::Content content = m_demuxer->getContent();
+
+    if(content == StreamInfo::Content::VIDEO || content == StreamInfo::Content::AUDIO) {
+        m_active = true;
+    }
+
+    output(o);
+}
+
+void DemuxerWorker::onFrameIndex(TsDemuxer::FrameIndex* index) {
+    m_index = *index;
+    m_hasIndex = true;
+}
+
+void DemuxerWorker::onStreamChange() {
+    publishInfo(true);
+}
+
+void DemuxerWorker::publishInfo(bool streamChange) {
+    m_info = *m_demuxer;
+
+    Output* o = new Output;
+    o->streamChange = streamChange;
+    o->hasInfo = true;
+    o->info = m_info;
+
+    output(o);
+}
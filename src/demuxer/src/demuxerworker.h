@@ -0,0 +1,194 @@
+/*
+ *      vdr-plugin-robotv - roboTV server plugin for VDR
+ *
+ *      Copyright (C) 2016 Alexander Pipelka
+ *
+ *      https://github.com/pipelka/vdr-plugin-robotv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#ifndef ROBOTV_DEMUXERWORKER_H
+#define ROBOTV_DEMUXERWORKER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "robotvdmx/demuxer.h"
+#include "robotvdmx/pes.h"
+#include "spscqueue.h"
+
+/**
+ * Runs a stream demuxer in its own thread.
+ * TS packets are passed through a lock-free input queue, the resulting
+ * stream packets are collected in an output queue which is drained by
+ * the thread feeding the worker. The worker owns the demuxer, which is only
+ * touched by the worker thread. Changes of the stream information are passed
+ * as a copy through the output queue.
+ */
+class DemuxerWorker : public TsDemuxer::Listener {
+public:
+
+    struct Output {
+        bool streamChange = false;
+
+        // stream information changed (copy of the demuxer)
+        bool hasInfo = false;
+
+        StreamInfo info;
+
+        bool hasIndex = false;
+
+        TsDemuxer::FrameIndex index;
+
+        TsDemuxer::StreamPacket packet;
+
+        std::vector<uint8_t> data;
+    };
+
+    DemuxerWorker(const StreamInfo& info, size_t queueSize);
+
+    virtual ~DemuxerWorker();
+
+    void start();
+
+    void stop();
+
+    /**
+     * Queue a TS packet (producer thread).
+     * Never blocks, returns false if the input queue is full.
+     */
+    bool put(const uint8_t* packet, int64_t streamPosition);
+
+    void reset();
+
+    void flush();
+
+    bool isFlushed() const {
+        return m_flushed;
+    }
+
+    // all queued TS packets processed
+    bool isIdle() const {
+        return m_input.empty();
+    }
+
+    // audio / video stream delivering packets (until reset)
+    bool isActive() const {
+        return m_active;
+    }
+
+    // output queue (consumer thread)
+
+    Output* front() {
+        Output** p = m_output.front();
+        return (p == nullptr) ? nullptr : *p;
+    }
+
+    void pop() {
+        Output* o = front();
+
+        if(o != nullptr && !o->hasInfo && o->packet.dts != DVD_NOPTS_VALUE) {
+            m_lastDts = o->packet.dts;
+        }
+
+        m_output.pop();
+    }
+
+    // DTS of the last packet taken from the output queue
+    int64_t getLastDts() const {
+        return m_lastDts;
+    }
+
+    size_t pending() const {
+        return m_output.size();
+    }
+
+    // stream information of the demuxer (don't call after start())
+    const StreamInfo& getInfo() const {
+        return m_info;
+    }
+
+protected:
+
+    void onStreamPacket(TsDemuxer::StreamPacket* p);
+
+    void onStreamChange();
+
+    void onFrameIndex(TsDemuxer::FrameIndex* index);
+
+private:
+
+    enum class Command {
+        PACKET,
+        RESET,
+        FLUSH
+    };
+
+    struct Input {
+        Command command = Command::PACKET;
+
+        int64_t streamPosition = 0;
+
+        uint8_t data[TS_SIZE];
+    };
+
+    void action();
+
+    bool queue(const Input& input);
+
+    void output(Output* p);
+
+    void publishInfo(bool streamChange);
+
+    TsDemuxer* m_demuxer;
+
+    // last stream information passed to the consumer
+    StreamInfo m_info;
+
+    SpscQueue<Input> m_input;
+
+    SpscQueue<Output*> m_output;
+
+    std::thread m_thread;
+
+    std::mutex m_mutex;
+
+    std::condition_variable m_cond;
+
+    std::atomic<bool> m_running;
+
+    std::atomic<bool> m_sleeping;
+
+    std::atomic<bool> m_flushed;
+
+    std::atomic<bool> m_active;
+
+    // consumer thread
+    int64_t m_lastDts = DVD_NOPTS_VALUE;
+
+    // frame index of the next stream packet
+    bool m_hasIndex = false;
+
+    TsDemuxer::FrameIndex m_index;
+
+};
+
+#endif // ROBOTV_DEMUXERWORKER_H
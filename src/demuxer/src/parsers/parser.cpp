@@ -22,11 +22,12 @@
  *
  */
 
+#include <string.h>
 #include "robotvdmx/pes.h"
 
 #include "parser.h"
 
-Parser::Parser(TsDemuxer* demuxer, int buffersize, int packetsize) : RingBuffer(buffersize, packetsize), m_demuxer(demuxer), m_startup(true) {
+Parser::Parser(TsDemuxer* demuxer, int buffersize, int packetsize) : RingBuffer(buffersize, packetsize, true), m_demuxer(demuxer), m_startup(true) {
     m_sampleRate = 0;
     m_bitRate = 0;
     m_channels = 0;
@@ -36,9 +37,13 @@ Parser::Parser(TsDemuxer* demuxer, int buffersize, int packetsize) : RingBuffer(
 
     m_curPts = DVD_NOPTS_VALUE;
     m_curDts = DVD_NOPTS_VALUE;
+    m_framePosition = 0;
 
     m_lastPts = DVD_NOPTS_VALUE;
     m_lastDts = DVD_NOPTS_VALUE;
+
+    m_syncWord = 0;
+    m_syncMask = 0;
 }
 
 Parser::~Parser() {
@@ -79,6 +84,7 @@ void Parser::sendPayload(unsigned char* payload, int length) {
     pkt.dts = m_curDts;
     pkt.pts = m_curPts;
     pkt.frameType = m_frameType;
+    pkt.framePosition = m_framePosition;
 
     m_demuxer->sendPacket(&pkt);
 }
@@ -90,6 +96,7 @@ void Parser::putData(unsigned char* data, int length, bool pusi) {
         data += offset;
         length -= offset;
 
+        m_framePosition = m_demuxer->getStreamPosition();
         m_startup = false;
     }
 
@@ -177,14 +184,37 @@ int Parser::parsePayload(unsigned char* payload, int length) {
 
 int Parser::findAlignmentOffset(unsigned char* buffer, int buffersize, int o, int& framesize) {
     framesize = 0;
+    int end = buffersize - m_headerSize;
 
     // seek sync
-    while(o < (buffersize - m_headerSize) && !checkAlignmentHeader(buffer + o, framesize, false)) {
-        o++;
+    if(m_syncMask != 0) {
+        uint8_t first = m_syncWord >> 8;
+
+        while(o < end) {
+            uint8_t* p = (uint8_t*)memchr(buffer + o, first, end - o);
+
+            if(p == NULL) {
+                return -1;
+            }
+
+            o = p - buffer;
+
+            // cheap sync word check before decoding the full header
+            if(o + 1 < buffersize && (((p[0] << 8) | p[1]) & m_syncMask) == m_syncWord && checkAlignmentHeader(p, framesize, false)) {
+                break;
+            }
+
+            o++;
+        }
+    }
+    else {
+        while(o < end && !checkAlignmentHeader(buffer + o, framesize, false)) {
+            o++;
+        }
     }
 
     // not found
-    if(o >= buffersize - m_headerSize || framesize <= 0) {
+    if(o >= end || framesize <= 0) {
         return -1;
     }
 
@@ -211,6 +241,11 @@ int Parser::findStartCode(unsigned char* buffer, int buffersize, int offset, uin
     return -1;
 }
 
+void Parser::setSyncWord(uint16_t syncword, uint16_t mask) {
+    m_syncWord = syncword & mask;
+    m_syncMask = mask;
+}
+
 void Parser::reset() {
     clear();
 
@@ -53,12 +53,17 @@ protected:
 
     int findStartCode(unsigned char* buffer, int buffersize, int offset, uint32_t startcode, uint32_t mask = 0xFFFFFFFF);
 
+    // sync word prefilter for the frame resync (first byte must be matched exactly)
+    void setSyncWord(uint16_t syncword, uint16_t mask);
+
     TsDemuxer* m_demuxer;
 
     int64_t m_curPts;
 
     int64_t m_curDts;
 
+    int64_t m_framePosition; // stream position of the current frame
+
     int m_sampleRate;
 
     int m_bitRate;
@@ -79,6 +84,10 @@ private:
 
     int64_t m_lastDts;
 
+    uint16_t m_syncWord;
+
+    uint16_t m_syncMask;
+
     void putData(unsigned char* data, int size, bool pusi);
 
     int findAlignmentOffset(unsigned char* buffer, int buffersize, int startoffset, int& framesize);
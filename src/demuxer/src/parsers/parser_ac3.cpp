@@ -28,9 +28,10 @@
 
 #include "parser_ac3.h"
 
-ParserAc3::ParserAc3(TsDemuxer* demuxer) : Parser(demuxer, 64 * 1024, 4096) {
+ParserAc3::ParserAc3(TsDemuxer* demuxer) : Parser(demuxer, 16 * 1024, 4096) {
     m_headerSize = AC3_HEADER_SIZE;
     m_enhanced = false;
+    setSyncWord(0x0B77, 0xFFFF);
 }
 
 bool ParserAc3::checkAlignmentHeader(unsigned char* buffer, int& framesize, bool parse) {
@@ -27,8 +27,9 @@
 
 #include "parser_adts.h"
 
-ParserAdts::ParserAdts(TsDemuxer* demuxer) : Parser(demuxer, 64 * 1024, 8192) {
+ParserAdts::ParserAdts(TsDemuxer* demuxer) : Parser(demuxer, 32 * 1024, 8192) {
     m_headerSize = 9; // header is 9 bytes long (with CRC)
+    setSyncWord(0xFFF0, 0xFFF6); // syncword 0xFFF, layer 0
 }
 
 bool ParserAdts::ParseAudioHeader(uint8_t* buffer, int& channels, int& samplerate, int& framesize) {
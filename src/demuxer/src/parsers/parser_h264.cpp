@@ -22,6 +22,8 @@
  *
  */
 
+#include <algorithm>
+
 #include "parser_h264.h"
 
 // H264 profiles
@@ -48,13 +50,7 @@ const ParserH264::pixel_aspect_t ParserH264::m_aspect_ratios[17] = {
 
 // golomb decoding
 uint32_t ParserH264::readGolombUe(BitStream* bs) {
-    int leadingZeroBits = -1;
-
-    for(uint32_t b = 0; !b; ++leadingZeroBits) {
-        b = bs->getBits(1);
-    }
-
-    return ((1 << leadingZeroBits) - 1) + bs->getBits(leadingZeroBits);
+    return bs->getGolombUe();
 }
 
 int32_t ParserH264::readGolombSe(BitStream* bs) {
@@ -74,131 +70,127 @@ int32_t ParserH264::readGolombSe(BitStream* bs) {
 ParserH264::ParserH264(TsDemuxer* demuxer) : ParserPes(demuxer, 1024 * 1024) {
     m_scale = 0;
     m_rate = 0;
-}
-
-uint8_t* ParserH264::extractNal(uint8_t* packet, int length, int nal_offset, int& nal_len) {
-    int e = findStartCode(packet, length, nal_offset, 0x00000001);
+    m_auFrameType = StreamInfo::FrameType::UNKNOWN;
+    m_idrFrame = false;
+    m_spsFound = false;
 
-    if(e == -1) {
-        e = length;
-    }
-
-    int l = e - nal_offset;
+    enableNalScanner(0x00000001);
+}
 
-    if(l <= 0) {
+uint8_t* ParserH264::extractNal(uint8_t* data, int length, int& nal_len) {
+    if(length <= 0) {
         return NULL;
     }
 
-    uint8_t* nal_data = new uint8_t[l];
-    nal_len = nalUnescape(nal_data, packet + nal_offset, l);
+    uint8_t* nal_data = new uint8_t[length];
+    nal_len = nalUnescape(nal_data, data, length);
 
     return nal_data;
 }
 
-int ParserH264::parsePayload(unsigned char* data, int length) {
-    int o = 0;
-    int sps_start = -1;
-    int pps_start = -1;
-    int nal_len = 0;
-
-    if(length < 4) {
-        return length;
+void ParserH264::parseNalHeader(unsigned char* data, int length) {
+    if(length < 1) {
+        return;
     }
 
-    m_frameType = StreamInfo::FrameType::UNKNOWN;
-    bool idr_frame = false;
+    uint8_t nal_type = data[0] & 0x1F;
 
-    // iterate through all NAL units
-    while((o = findStartCode(data, length, o, 0x00000001)) >= 0) {
-        o += 4;
+    // NAL_IDR
+    if(nal_type == NAL_IDR) {
+        m_idrFrame = true;
+    }
 
-        if(o >= length) {
-            return length;
-        }
+    // NAL_SLH (the slice type of the first slice is within the first bytes)
+    else if(nal_type == NAL_SLH && length >= 2 && m_auFrameType == StreamInfo::FrameType::UNKNOWN) {
+        uint8_t slh[32];
+        int nal_len = nalUnescape(slh, data + 1, std::min(length - 1, (int)sizeof(slh)));
+        m_auFrameType = parseSlh(slh, nal_len);
+    }
+}
 
-        uint8_t nal_type = data[o] & 0x1F;
+void ParserH264::parseNal(unsigned char* data, int length) {
+    if(length < 2) {
+        return;
+    }
 
-        // NAL_SLH
-        if(nal_type == NAL_SLH && length - o > 1) {
-            o++;
-            uint8_t* nal_data = extractNal(data, length, o, nal_len);
+    uint8_t nal_type = data[0] & 0x1F;
+    int nal_len = 0;
 
-            if(nal_data != NULL) {
-                parseSlh(nal_data, nal_len);
-                delete[] nal_data;
-            }
-        }
+    // NAL_PPS
+    if(nal_type == NAL_PPS) {
+        uint8_t* pps_data = extractNal(data + 1, length - 1, nal_len);
 
-        // NAL_PPS
-        else if(nal_type == NAL_PPS && length - o > 1) {
-            o++;
-            pps_start = o;
+        // register PPS data (decoder specific data)
+        if(pps_data != NULL) {
+            m_demuxer->setVideoDecoderData(NULL, 0, pps_data, nal_len);
+            delete[] pps_data;
         }
+    }
 
-        // NAL_SPS
-        else if(nal_type == NAL_SPS && length - o > 1) {
-            o++;
-            sps_start = o;
-        }
+    // NAL_SPS
+    else if(nal_type == NAL_SPS) {
+        uint8_t* nal_data = extractNal(data + 1, length - 1, nal_len);
 
-        // NAL_IDR
-        else if(nal_type == NAL_IDR) {
-            idr_frame = true;
+        if(nal_data == NULL) {
+            return;
         }
-    }
 
-    // extract and register PPS data (decoder specific data)
-    if(pps_start != -1) {
-        uint8_t* pps_data = extractNal(data, length, pps_start, nal_len);
+        m_spsFound = true;
 
-        if(pps_data != NULL) {
-            m_demuxer->setVideoDecoderData(NULL, 0, pps_data, nal_len);
-            delete[] pps_data;
+        // register SPS data (decoder specific data)
+        m_demuxer->setVideoDecoderData(nal_data, nal_len, NULL, 0);
+
+        int width = 0;
+        int height = 0;
+        pixel_aspect_t pixelaspect = { 1, 1 };
+
+        bool rc = parseSps(nal_data, nal_len, pixelaspect, width, height);
+        delete[] nal_data;
+
+        if(!rc) {
+            return;
         }
-    }
 
-    // exit if we do not have SPS data
-    if(sps_start == -1) {
-        return length;
+        double PAR = (double)pixelaspect.num / (double)pixelaspect.den;
+        double DAR = (PAR * width) / height;
+
+        // register the video information right away
+        // (we do not need to wait for the end of the access unit)
+        m_demuxer->setVideoInformation(m_scale, m_rate, height, width, (int)(DAR * 10000));
     }
+}
 
-    // extract SPS
-    uint8_t* nal_data = extractNal(data, length, sps_start, nal_len);
+int ParserH264::parsePayload(unsigned char* data, int length) {
+    // process the remaining NAL units of the access unit
+    scanNalUnits(data, length, true);
 
-    if(nal_data == NULL) {
-        return length;
-    }
+    m_frameType = m_auFrameType;
 
     // no SLH present but SPS
     // assume it's a stream with IDR frames
-    if(m_frameType == StreamInfo::FrameType::UNKNOWN) {
+    if(m_frameType == StreamInfo::FrameType::UNKNOWN && m_spsFound) {
         m_frameType = StreamInfo::FrameType::IFRAME;
     }
 
-    // register SPS data (decoder specific data)
-    m_demuxer->setVideoDecoderData(nal_data, nal_len, NULL, 0);
-
-    int width = 0;
-    int height = 0;
-    pixel_aspect_t pixelaspect = { 1, 1 };
-
     // IDR frame ?
-    if(m_frameType != StreamInfo::FrameType::IFRAME && idr_frame) {
+    if(m_idrFrame) {
         m_frameType = StreamInfo::FrameType::IFRAME;
     }
 
-    bool rc = parseSps(nal_data, nal_len, pixelaspect, width, height);
-    delete[] nal_data;
+    // start over with the next access unit
+    m_auFrameType = StreamInfo::FrameType::UNKNOWN;
+    m_idrFrame = false;
+    m_spsFound = false;
 
-    if(!rc) {
-        return length;
-    }
+    return length;
+}
 
-    double PAR = (double)pixelaspect.num / (double)pixelaspect.den;
-    double DAR = (PAR * width) / height;
+void ParserH264::reset() {
+    ParserPes::reset();
 
-    m_demuxer->setVideoInformation(m_scale, m_rate, height, width, (int)(DAR * 10000));
-    return length;
+    m_auFrameType = StreamInfo::FrameType::UNKNOWN;
+    m_idrFrame = false;
+    m_spsFound = false;
 }
 
 int ParserH264::nalUnescape(uint8_t* dst, const uint8_t* src, int len) {
@@ -218,7 +210,7 @@ int ParserH264::nalUnescape(uint8_t* dst, const uint8_t* src, int len) {
     return d;
 }
 
-void ParserH264::parseSlh(uint8_t* buf, int len) {
+StreamInfo::FrameType ParserH264::parseSlh(uint8_t* buf, int len) {
     BitStream bs(buf, len * 8);
 
     readGolombUe(&bs); // first_mb_in_slice
@@ -230,23 +222,17 @@ void ParserH264::parseSlh(uint8_t* buf, int len) {
 
     switch(type) {
         case 0:
-            m_frameType = StreamInfo::FrameType::PFRAME;
-            break;
+            return StreamInfo::FrameType::PFRAME;
 
         case 1:
-            m_frameType = StreamInfo::FrameType::BFRAME;
-            break;
+            return StreamInfo::FrameType::BFRAME;
 
         case 2:
-            m_frameType = StreamInfo::FrameType::IFRAME;
-            break;
+            return StreamInfo::FrameType::IFRAME;
 
         default:
-            m_frameType = StreamInfo::FrameType::UNKNOWN;
-            break;
+            return StreamInfo::FrameType::UNKNOWN;
     }
-
-    return;
 }
 
 bool ParserH264::parseSps(uint8_t* buf, int len, pixel_aspect_t& pixelaspect, int& width, int& height) {
@@ -35,6 +35,8 @@ public:
 
     int parsePayload(unsigned char* data, int length);
 
+    void reset();
+
 protected:
 
     typedef struct {
@@ -45,7 +47,11 @@ protected:
     // pixel aspect ratios
     static const pixel_aspect_t m_aspect_ratios[17];
 
-    uint8_t* extractNal(uint8_t* packet, int length, int nal_offset, int& nal_len);
+    void parseNalHeader(unsigned char* data, int length);
+
+    void parseNal(unsigned char* data, int length);
+
+    uint8_t* extractNal(uint8_t* data, int length, int& nal_len);
 
     int nalUnescape(uint8_t* dst, const uint8_t* src, int len);
 
@@ -57,11 +63,18 @@ protected:
 
     int m_rate;
 
+    // access unit state (collected while the NAL units arrive)
+    StreamInfo::FrameType m_auFrameType;
+
+    bool m_idrFrame;
+
+    bool m_spsFound;
+
 private:
 
     bool parseSps(uint8_t* buf, int len, pixel_aspect_t& pixel_aspect, int& width, int& height);
 
-    void parseSlh(uint8_t* buf, int len);
+    StreamInfo::FrameType parseSlh(uint8_t* buf, int len);
 
 };
 
@@ -37,96 +37,89 @@
 #define SUFFIX_SEI_NUT 40
 
 ParserH265::ParserH265(TsDemuxer* demuxer) : ParserH264(demuxer) {
+    enableNalScanner(0x00000001, 0x00FFFFFF);
 }
 
-int ParserH265::parsePayload(unsigned char* data, int length) {
-    int o = 0;
-    int sps_start = -1;
-    int nal_len = 0;
+void ParserH265::parseNalHeader(unsigned char* data, int length) {
+    if(length < 1) {
+        return;
+    }
 
-    m_frameType = StreamInfo::FrameType::UNKNOWN;
+    uint8_t nal_type = (data[0] & 0x7E) >> 1;
 
-    if(length < 4) {
-        return length;
+    // key frame ?
+    if(nal_type >= BLA_W_LP && nal_type <= CRA_NUT) {
+        m_auFrameType = StreamInfo::FrameType::IFRAME;
     }
+}
 
-    // iterate through all NAL units
-    while((o = findStartCode(data, length, o, 0x00000001, 0x00FFFFFF)) >= 0) {
-        o += 4;
+void ParserH265::parseNal(unsigned char* data, int length) {
+    if(length < 2) {
+        return;
+    }
 
-        if(o >= length) {
-            return length;
-        }
+    uint8_t nal_type = (data[0] & 0x7E) >> 1;
+    int nal_len = 0;
 
-        uint8_t nal_type = (data[o] & 0x7E) >> 1;
+    // PPS_NUT
+    if(nal_type == PPS_NUT) {
+        uint8_t* pps_data = extractNal(data + 1, length - 1, nal_len);
 
-        // key frame ?
-        if(nal_type >= BLA_W_LP && nal_type <= CRA_NUT) {
-            m_frameType = StreamInfo::FrameType::IFRAME;
+        if(pps_data != NULL) {
+            m_demuxer->setVideoDecoderData(NULL, 0, pps_data, nal_len);
+            delete[] pps_data;
         }
+    }
 
-        // PPS_NUT
-        if(nal_type == PPS_NUT && length - o > 1) {
-            o++;
-            uint8_t* pps_data = extractNal(data, length, o, nal_len);
+    // VPS_NUT
+    else if(nal_type == VPS_NUT) {
+        uint8_t* vps_data = extractNal(data + 1, length - 1, nal_len);
 
-            if(pps_data != NULL) {
-                m_demuxer->setVideoDecoderData(NULL, 0, pps_data, nal_len);
-                delete[] pps_data;
-            }
+        if(vps_data != NULL) {
+            m_demuxer->setVideoDecoderData(NULL, 0, NULL, 0, vps_data, nal_len);
+            delete[] vps_data;
         }
+    }
 
-        // VPS_NUT
-        else if(nal_type == VPS_NUT && length - o > 1) {
-            o++;
-            uint8_t* vps_data = extractNal(data, length, o, nal_len);
-
-            if(vps_data != NULL) {
-                m_demuxer->setVideoDecoderData(NULL, 0, NULL, 0, vps_data, nal_len);
-                delete[] vps_data;
-            }
-        }
+    // SPS_NUT
+    else if(nal_type == SPS_NUT) {
+        uint8_t* nal_data = extractNal(data + 1, length - 1, nal_len);
 
-        // SPS_NUT
-        else if(nal_type == SPS_NUT && length - o > 1) {
-            o++;
-            sps_start = o;
+        if(nal_data == NULL) {
+            return;
         }
-    }
 
-    // exit if we do not have SPS data
-    if(sps_start == -1) {
-        return length;
-    }
+        // register SPS data (decoder specific data)
+        m_demuxer->setVideoDecoderData(nal_data, nal_len, NULL, 0);
 
-    // extract SPS
-    uint8_t* nal_data = extractNal(data, length, sps_start, nal_len);
+        int width = 0;
+        int height = 0;
+        pixel_aspect_t pixelaspect = { 1, 1 };
 
-    if(nal_data == NULL) {
-        return length;
-    }
+        bool rc = parseSps(nal_data, nal_len, pixelaspect, width, height);
+        delete[] nal_data;
 
-    // register SPS data (decoder specific data)
-    m_demuxer->setVideoDecoderData(nal_data, nal_len, NULL, 0);
+        if(!rc) {
+            return;
+        }
 
-    int width = 0;
-    int height = 0;
-    pixel_aspect_t pixelaspect = { 1, 1 };
+        double PAR = (double)pixelaspect.num / (double)pixelaspect.den;
+        double DAR = (PAR * width) / height;
 
-    bool rc = parseSps(nal_data, nal_len, pixelaspect, width, height);
-    delete[] nal_data;
+        m_rate = 50;
+        m_scale = 1;
 
-    if(!rc) {
-        return length;
+        m_demuxer->setVideoInformation(m_scale, m_rate, height, width, (int)(DAR * 10000));
     }
+}
 
-    double PAR = (double)pixelaspect.num / (double)pixelaspect.den;
-    double DAR = (PAR * width) / height;
+int ParserH265::parsePayload(unsigned char* data, int length) {
+    // process the remaining NAL units of the access unit
+    scanNalUnits(data, length, true);
 
-    m_rate = 50;
-    m_scale = 1;
+    m_frameType = m_auFrameType;
+    m_auFrameType = StreamInfo::FrameType::UNKNOWN;
 
-    m_demuxer->setVideoInformation(m_scale, m_rate, height, width, (int)(DAR * 10000));
     return length;
 }
 
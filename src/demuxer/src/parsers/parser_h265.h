@@ -34,6 +34,12 @@ public:
 
     int parsePayload(unsigned char* data, int length);
 
+protected:
+
+    void parseNalHeader(unsigned char* data, int length);
+
+    void parseNal(unsigned char* data, int length);
+
 private:
 
     void skipScalingList(BitStream& bs);
@@ -49,8 +49,9 @@ static const int Coefficients[2][3] = {
 const int SlotSizes[3] = { 4, 1, 1 };
 
 
-ParserMpeg2Audio::ParserMpeg2Audio(TsDemuxer* demuxer) : Parser(demuxer, 64 * 1024, 2048) {
+ParserMpeg2Audio::ParserMpeg2Audio(TsDemuxer* demuxer) : Parser(demuxer, 16 * 1024, 2048) {
     m_headerSize = 4;
+    setSyncWord(0xFFE0, 0xFFE0); // syncword 0xFFE
 }
 
 bool ParserMpeg2Audio::parseAudioHeader(uint8_t* buffer, int& channels, int& samplerate, int& bitrate, int& framesize) {
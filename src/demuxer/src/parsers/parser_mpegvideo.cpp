@@ -76,6 +76,8 @@ static StreamInfo::FrameType ConvertFrameType(int frametype) {
 }
 
 ParserMpeg2Video::ParserMpeg2Video(TsDemuxer* demuxer) : ParserPes(demuxer, 512 * 1024), m_frameDifference(0), m_lastDts(DVD_NOPTS_VALUE) {
+    // several pictures may start in one PES packet
+    enableFramePositions();
 }
 
 StreamInfo::FrameType ParserMpeg2Video::parsePicture(unsigned char* data, int length) {
@@ -141,6 +143,7 @@ int ParserMpeg2Video::parsePayload(unsigned char* data, int length) {
 
         // parse and send payload data
         m_frameType = parsePicture(data + o, e - o);
+        m_framePosition = getFramePosition(s);
         Parser::sendPayload(data + s, e - s);
 
         // get next picture offsets
@@ -155,6 +158,7 @@ int ParserMpeg2Video::parsePayload(unsigned char* data, int length) {
 
     // append last part
     m_frameType = parsePicture(data + o, length - o);
+    m_framePosition = getFramePosition(s);
     Parser::sendPayload(data + s, length - s);
 
     return length;
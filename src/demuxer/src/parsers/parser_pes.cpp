@@ -26,45 +26,198 @@
 
 #include "parser_pes.h"
 
+// bytes of a NAL unit passed to parseNalHeader()
+#define NAL_HEADER_SIZE 32
+
 ParserPes::ParserPes(TsDemuxer* demuxer, int buffersize) : Parser(demuxer, buffersize, 0) {
     m_startup = true;
+    m_scanNal = false;
+    m_startCode = 0;
+    m_startCodeMask = 0;
+    m_scanOffset = 0;
+    m_nalOffset = -1;
+    m_nalHeaderParsed = false;
+    m_pesLength = 0;
+    m_trackPositions = false;
 }
 
 void ParserPes::parse(unsigned char* data, int size, bool pusi) {
 
     // packet completely assembled ?
-    if(!m_startup) {
-        int length = 0;
-        uint8_t* buffer = get(length);
-
-        if(pusi && buffer != NULL) {
-            // parse payload
-            if(length > 0) {
-                int len = parsePayload(buffer, length);
-
-                // send payload data
-                sendPayload(buffer, len);
-            }
-
-            m_curDts = DVD_NOPTS_VALUE;
-            m_curPts = DVD_NOPTS_VALUE;
-        }
+    if(!m_startup && pusi) {
+        sendPacket();
     }
 
     // new packet
     if(pusi) {
         // strip PES header
         int offset = parsePesHeader(data, size);
+        m_pesLength = PesHasLength(data) ? PesLength(data) - offset : 0;
+
         data += offset;
         size -= offset;
         m_startup = false;
 
         // reset buffer
         clear();
+
+        m_scanOffset = 0;
+        m_nalOffset = -1;
+        m_framePosition = m_demuxer->getStreamPosition();
+        m_positions.clear();
+
+        // complete packet in this TS payload - send it without buffering
+        if(!m_scanNal && m_pesLength > 0 && size >= m_pesLength) {
+            int len = parsePayload(data, m_pesLength);
+            sendPayload(data, len);
+
+            m_curDts = DVD_NOPTS_VALUE;
+            m_curPts = DVD_NOPTS_VALUE;
+            m_startup = true;
+            return;
+        }
     }
 
     // we start with the beginning of a packet
-    if(!m_startup) {
-        put(data, size);
+    if(m_startup) {
+        return;
     }
+
+    if(m_trackPositions) {
+        m_positions.emplace_back(available(), m_demuxer->getStreamPosition());
+    }
+
+    put(data, size);
+
+    int length = 0;
+    uint8_t* buffer = get(length);
+
+    if(buffer == NULL) {
+        return;
+    }
+
+    // look for NAL units as soon as the data arrives
+    if(m_scanNal) {
+        scanNalUnits(buffer, length, false);
+    }
+
+    // packet with known length completely assembled ?
+    // send it now and skip everything up to the next packet
+    if(m_pesLength > 0 && length >= m_pesLength) {
+        sendPacket();
+        clear();
+
+        m_scanOffset = 0;
+        m_nalOffset = -1;
+        m_startup = true;
+    }
+}
+
+void ParserPes::sendPacket() {
+    int length = 0;
+    uint8_t* buffer = get(length);
+
+    if(m_pesLength > 0 && length > m_pesLength) {
+        length = m_pesLength;
+    }
+
+    // parse payload
+    if(buffer != NULL && length > 0) {
+        int len = parsePayload(buffer, length);
+
+        // send payload data
+        sendPayload(buffer, len);
+    }
+
+    m_curDts = DVD_NOPTS_VALUE;
+    m_curPts = DVD_NOPTS_VALUE;
+}
+
+void ParserPes::reset() {
+    Parser::reset();
+
+    m_scanOffset = 0;
+    m_nalOffset = -1;
+    m_pesLength = 0;
+    m_positions.clear();
+}
+
+void ParserPes::enableNalScanner(uint32_t startcode, uint32_t mask) {
+    m_scanNal = true;
+    m_startCode = startcode;
+    m_startCodeMask = mask;
+}
+
+void ParserPes::scanNalUnits(unsigned char* data, int length, bool last) {
+    int o = m_scanOffset;
+
+    while((o = findStartCode(data, length, o, m_startCode, m_startCodeMask)) >= 0) {
+        // the previous NAL unit ends at the start code
+        // (a 3-byte start code is reported one byte early)
+        if(m_nalOffset >= 0) {
+            int end = (data[o] == 0) ? o : o + 1;
+
+            if(!m_nalHeaderParsed) {
+                parseNalHeader(data + m_nalOffset, end - m_nalOffset);
+            }
+
+            parseNal(data + m_nalOffset, end - m_nalOffset);
+        }
+
+        o += 4;
+        m_nalOffset = o;
+        m_nalHeaderParsed = false;
+    }
+
+    // header of the current NAL unit complete
+    // (a start code within the header would have been found already)
+    if(m_nalOffset >= 0 && !m_nalHeaderParsed && length - m_nalOffset >= NAL_HEADER_SIZE + 3) {
+        parseNalHeader(data + m_nalOffset, NAL_HEADER_SIZE);
+        m_nalHeaderParsed = true;
+    }
+
+    // rescan the last bytes, they may be part of a start code
+    m_scanOffset = length - 3;
+
+    if(m_scanOffset < m_nalOffset) {
+        m_scanOffset = m_nalOffset;
+    }
+
+    if(m_scanOffset < 0) {
+        m_scanOffset = 0;
+    }
+
+    if(last && m_nalOffset >= 0 && m_nalOffset < length) {
+        if(!m_nalHeaderParsed) {
+            parseNalHeader(data + m_nalOffset, length - m_nalOffset);
+        }
+
+        parseNal(data + m_nalOffset, length - m_nalOffset);
+        m_nalOffset = length;
+    }
+}
+
+void ParserPes::parseNalHeader(unsigned char*, int) {
+}
+
+void ParserPes::parseNal(unsigned char*, int) {
+}
+
+void ParserPes::enableFramePositions() {
+    m_trackPositions = true;
+    m_positions.reserve(64);
+}
+
+int64_t ParserPes::getFramePosition(int offset) const {
+    int64_t position = m_framePosition;
+
+    for(auto& p: m_positions) {
+        if(p.first > offset) {
+            break;
+        }
+
+        position = p.second;
+    }
+
+    return position;
 }
@@ -25,6 +25,7 @@
 #ifndef ROBOTV_DEMUXER_PES_H
 #define ROBOTV_DEMUXER_PES_H
 
+#include <vector>
 #include "parser.h"
 
 class ParserPes : public Parser {
@@ -34,6 +35,51 @@ public:
 
     void parse(unsigned char* data, int size, bool pusi);
 
+    void reset();
+
+protected:
+
+    // scan the incoming payload for NAL units (start code / mask)
+    void enableNalScanner(uint32_t startcode, uint32_t mask = 0xFFFFFFFF);
+
+    // report all NAL units not scanned so far (last = report the trailing NAL unit)
+    void scanNalUnits(unsigned char* data, int length, bool last);
+
+    // called for every NAL unit as soon as its first bytes arrived (data points to the NAL header)
+    virtual void parseNalHeader(unsigned char* data, int length);
+
+    // called for every complete NAL unit (data points to the NAL header)
+    virtual void parseNal(unsigned char* data, int length);
+
+    // record the stream position of every TS packet (for getFramePosition)
+    void enableFramePositions();
+
+    // stream position of the TS packet containing the given payload offset
+    int64_t getFramePosition(int offset) const;
+
+private:
+
+    void sendPacket();
+
+    bool m_scanNal;
+
+    uint32_t m_startCode;
+
+    uint32_t m_startCodeMask;
+
+    int m_scanOffset;
+
+    int m_nalOffset;
+
+    bool m_nalHeaderParsed;
+
+    int m_pesLength;
+
+    bool m_trackPositions;
+
+    // payload offset / stream position of every TS packet of the current PES
+    std::vector<std::pair<int, int64_t>> m_positions;
+
 };
 
 #endif // ROBOTV_DEMUXER_PES_H
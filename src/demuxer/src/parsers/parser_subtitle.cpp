@@ -24,7 +24,7 @@
 
 #include "parser_subtitle.h"
 
-ParserSubtitle::ParserSubtitle(TsDemuxer* demuxer) : ParserPes(demuxer, 64 * 1024) {
+ParserSubtitle::ParserSubtitle(TsDemuxer* demuxer) : ParserPes(demuxer, 32 * 1024) {
 }
 
 void ParserSubtitle::sendPayload(unsigned char* payload, int length) {
@@ -0,0 +1,98 @@
+/*
+ *      vdr-plugin-robotv - roboTV server plugin for VDR
+ *
+ *      Copyright (C) 2016 Alexander Pipelka
+ *
+ *      https://github.com/pipelka/vdr-plugin-robotv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#ifndef ROBOTV_SPSCQUEUE_H
+#define ROBOTV_SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * Lock-free single producer / single consumer queue.
+ * push() must only be called by the producer thread, front() and pop()
+ * only by the consumer thread. The capacity is rounded up to a power of 2.
+ */
+template<class T> class SpscQueue {
+public:
+
+    explicit SpscQueue(size_t capacity) : m_head(0), m_tail(0) {
+        size_t size = 1;
+
+        while(size < capacity) {
+            size <<= 1;
+        }
+
+        m_items.resize(size);
+        m_mask = size - 1;
+    }
+
+    bool push(const T& item) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+
+        if(tail - m_head.load(std::memory_order_acquire) > m_mask) {
+            return false;
+        }
+
+        m_items[tail & m_mask] = item;
+        m_tail.store(tail + 1);
+
+        return true;
+    }
+
+    T* front() {
+        size_t head = m_head.load(std::memory_order_relaxed);
+
+        if(head == m_tail.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+
+        return &m_items[head & m_mask];
+    }
+
+    void pop() {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    size_t size() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+private:
+
+    std::vector<T> m_items;
+
+    size_t m_mask;
+
+    std::atomic<size_t> m_head;
+
+    std::atomic<size_t> m_tail;
+
+};
+
+#endif // ROBOTV_SPSCQUEUE_H
@@ -28,6 +28,10 @@ StreamBundle::StreamBundle() : m_changed(false) {
 }
 
 void StreamBundle::addStream(const StreamInfo& s) {
+    addStream(StreamInfo(s));
+}
+
+void StreamBundle::addStream(StreamInfo&& s) {
     if(s.getPid() == 0 || s.getType() == StreamInfo::Type::NONE) {
         return;
     }
@@ -41,10 +45,16 @@ void StreamBundle::addStream(const StreamInfo& s) {
         }
     }
 
-    StreamInfo old = (*this)[s.getPid()];
-    (*this)[s.getPid()] = s;
+    iterator i = find(s.getPid());
+
+    if(i == end()) {
+        emplace(s.getPid(), std::move(s));
+        m_changed = true;
+        return;
+    }
 
-    m_changed = (old != s);
+    m_changed = (i->second != s);
+    i->second = std::move(s);
 }
 
 bool StreamBundle::isParsed() {
@@ -49,10 +49,6 @@ StreamInfo::StreamInfo(int pid, Type type, const char* lang) {
         strncpy(m_language, lang, 4);
     }
 
-    memset(m_sps, 0, sizeof(m_sps));
-    memset(m_pps, 0, sizeof(m_pps));
-    memset(m_vps, 0, sizeof(m_vps));
-
     setContent();
 }
 
@@ -73,9 +69,6 @@ void StreamInfo::Initialize() {
     m_type              = Type::NONE;
     m_content           = Content::NONE;
     m_parsed            = false;
-    m_spsLength         = 0;
-    m_ppsLength         = 0;
-    m_vpsLength         = 0;
 }
 
 bool StreamInfo::operator ==(const StreamInfo& rhs) const {
@@ -178,11 +171,19 @@ std::string StreamInfo::info() const {
         scale = 1;
     }
 
+    int spsLength = 0;
+    int ppsLength = 0;
+    int vpsLength = 0;
+
+    getVideoDecoderSps(spsLength);
+    getVideoDecoderPps(ppsLength);
+    getVideoDecoderVps(vpsLength);
+
     if(m_content == Content::AUDIO) {
         snprintf(buffer, sizeof(buffer), "%i Hz, %i channels, Lang: %s", m_sampleRate, m_channels, m_language);
     }
     else if(m_content == Content::VIDEO) {
-        snprintf(buffer, sizeof(buffer), "%ix%i DAR: %.2f FPS: %.3f SPS/PPS/VPS: %i/%i/%i bytes", m_width, m_height , (double)m_aspect / 10000, (double)m_fpsRate / (double)scale, (int)m_spsLength, (int)m_ppsLength, (int)m_vpsLength);
+        snprintf(buffer, sizeof(buffer), "%ix%i DAR: %.2f FPS: %.3f SPS/PPS/VPS: %i/%i/%i bytes", m_width, m_height , (double)m_aspect / 10000, (double)m_fpsRate / (double)scale, spsLength, ppsLength, vpsLength);
     }
     else if(m_content == Content::SUBTITLE) {
         snprintf(buffer, sizeof(buffer), "Lang: %s", m_language);
@@ -207,3 +208,79 @@ void StreamInfo::setSubtitlingDescriptor(unsigned char SubtitlingType, uint16_t
     m_ancillaryPageId   = AncillaryPageId;
     m_parsed            = true;
 }
+
+void StreamInfo::updateMetaData(const StreamInfo& info) {
+    memcpy(m_language, info.m_language, sizeof(m_language));
+
+    if(m_content == Content::SUBTITLE) {
+        m_subTitlingType    = info.m_subTitlingType;
+        m_compositionPageId = info.m_compositionPageId;
+        m_ancillaryPageId   = info.m_ancillaryPageId;
+    }
+}
+
+void StreamInfo::updateStreamData(const StreamInfo& info) {
+    m_fpsScale    = info.m_fpsScale;
+    m_fpsRate     = info.m_fpsRate;
+    m_height      = info.m_height;
+    m_width       = info.m_width;
+    m_aspect      = info.m_aspect;
+    m_channels    = info.m_channels;
+    m_sampleRate  = info.m_sampleRate;
+    m_bitRate     = info.m_bitRate;
+    m_parsed      = info.m_parsed;
+    m_decoderData = info.m_decoderData;
+}
+
+static bool equals(const uint8_t* a, size_t aLength, const uint8_t* b, size_t bLength) {
+    return (aLength == bLength) && (aLength == 0 || memcmp(a, b, aLength) == 0);
+}
+
+void StreamInfo::setVideoDecoderData(const uint8_t* sps, size_t spsLength, const uint8_t* pps, size_t ppsLength, const uint8_t* vps, size_t vpsLength) {
+    int length = 0;
+
+    // skip unchanged parameter sets (they are repeated with every GOP)
+    if((sps == NULL || equals(getVideoDecoderSps(length), length, sps, spsLength)) &&
+       (pps == NULL || equals(getVideoDecoderPps(length), length, pps, ppsLength)) &&
+       (vps == NULL || equals(getVideoDecoderVps(length), length, vps, vpsLength))) {
+        return;
+    }
+
+    DecoderData* data = new DecoderData;
+
+    if(m_decoderData) {
+        *data = *m_decoderData;
+    }
+
+    if(sps != NULL && spsLength <= sizeof(data->sps)) {
+        data->spsLength = spsLength;
+        memcpy(data->sps, sps, spsLength);
+    }
+
+    if(pps != NULL && ppsLength <= sizeof(data->pps)) {
+        data->ppsLength = ppsLength;
+        memcpy(data->pps, pps, ppsLength);
+    }
+
+    if(vps != NULL && vpsLength <= sizeof(data->vps)) {
+        data->vpsLength = vpsLength;
+        memcpy(data->vps, vps, vpsLength);
+    }
+
+    m_decoderData.reset(data);
+}
+
+const uint8_t* StreamInfo::getVideoDecoderSps(int& length) const {
+    length = m_decoderData ? m_decoderData->spsLength : 0;
+    return length == 0 ? NULL : m_decoderData->sps;
+}
+
+const uint8_t* StreamInfo::getVideoDecoderPps(int& length) const {
+    length = m_decoderData ? m_decoderData->ppsLength : 0;
+    return length == 0 ? NULL : m_decoderData->pps;
+}
+
+const uint8_t* StreamInfo::getVideoDecoderVps(int& length) const {
+    length = m_decoderData ? m_decoderData->vpsLength : 0;
+    return length == 0 ? NULL : m_decoderData->vps;
+}
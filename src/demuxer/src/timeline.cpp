@@ -0,0 +1,72 @@
+/*
+ *      vdr-plugin-robotv - roboTV server plugin for VDR
+ *
+ *      Copyright (C) 2016 Alexander Pipelka
+ *
+ *      https://github.com/pipelka/vdr-plugin-robotv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "robotvdmx/demuxer.h"
+#include "robotvdmx/timeline.h"
+
+// maximum gap between two timestamps of the reference stream (10 seconds)
+#define MAX_TIMESTAMP_GAP (10 * 90000)
+
+Timeline::Timeline() {
+    reset();
+}
+
+void Timeline::reset() {
+    m_lastTs = DVD_NOPTS_VALUE;
+    m_lastTime = DVD_NOPTS_VALUE;
+}
+
+int64_t Timeline::stamp(int64_t ts, bool reference) {
+    if(ts == DVD_NOPTS_VALUE) {
+        return DVD_NOPTS_VALUE;
+    }
+
+    // first timestamp starts the timeline
+    if(m_lastTs == DVD_NOPTS_VALUE) {
+        if(!reference) {
+            return ts;
+        }
+
+        m_lastTs = ts;
+        m_lastTime = ts;
+        return ts;
+    }
+
+    int64_t delta = difference(ts, m_lastTs);
+
+    // discontinuity - continue the timeline
+    // (the reference stream must not go back in time)
+    if(delta > MAX_TIMESTAMP_GAP || delta < -MAX_TIMESTAMP_GAP || (reference && delta < 0)) {
+        delta = 0;
+    }
+
+    int64_t time = m_lastTime + delta;
+
+    if(reference) {
+        m_lastTs = ts;
+        m_lastTime = time;
+    }
+
+    return time;
+}
@@ -27,24 +27,63 @@
 
 #include "bitstream.h"
 
-int BitStream::getBit(void) {
-    if(m_index >= m_length) {
-        return 1;
+void BitStream::fillCache(void) {
+    int byteIndex = m_index >> 3;
+    int byteLength = (m_length + 7) >> 3;
+
+    m_cacheIndex = byteIndex << 3;
+
+    // fast path, all 8 bytes within the buffer
+    if(byteIndex >= 0 && byteIndex + 8 <= byteLength) {
+        const uint8_t* p = m_data + byteIndex;
+        m_cache =
+            ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) | ((uint64_t)p[2] << 40) | ((uint64_t)p[3] << 32) |
+            ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) | ((uint64_t)p[6] << 8) | (uint64_t)p[7];
+    }
+    else {
+        m_cache = 0;
+
+        for(int i = 0; i < 8; i++) {
+            int b = byteIndex + i;
+            m_cache = (m_cache << 8) | ((b >= 0 && b < byteLength) ? m_data[b] : 0xFF);
+        }
     }
 
-    int r = (m_data[m_index >> 3] >> (7 - (m_index & 7))) & 1;
-    ++m_index;
-    return r;
+    // pad bits past the end of the stream with ones
+    int valid = m_length - m_cacheIndex;
+
+    if(valid < 64) {
+        m_cache |= (valid <= 0) ? ~(uint64_t)0 : (~(uint64_t)0 >> valid);
+    }
 }
 
-uint32_t BitStream::getBits(int n) {
-    uint32_t r = 0;
+uint32_t BitStream::getGolombUe(void) {
+    int offset = m_index - m_cacheIndex;
+
+    if(m_cacheIndex < 0 || offset < 0 || offset > 32) {
+        fillCache();
+        offset = m_index - m_cacheIndex;
+    }
+
+    // count leading zero bits of the next 32 bits
+    uint32_t w = (uint32_t)((m_cache << offset) >> 32);
+
+    if(w == 0) {
+        // invalid code (more than 31 leading zeros)
+        skipBits(32);
+        return 0xFFFFFFFF;
+    }
+
+    int leadingZeroBits = __builtin_clz(w);
 
-    while(n--) {
-        r |= getBit() << n;
+    // fast path, the whole code is within the next 32 bits
+    if(2 * leadingZeroBits + 1 <= 32) {
+        m_index += 2 * leadingZeroBits + 1;
+        return (w >> (31 - 2 * leadingZeroBits)) - 1;
     }
 
-    return r;
+    skipBits(leadingZeroBits + 1);
+    return ((1U << leadingZeroBits) - 1) + getBits(leadingZeroBits);
 }
 
 void BitStream::byteAlign(void) {
@@ -69,5 +108,6 @@ bool BitStream::setLength(int Length) {
     }
 
     m_length = Length;
+    m_cacheIndex = -1;
     return true;
 }
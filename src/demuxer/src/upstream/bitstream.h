@@ -33,14 +33,32 @@
 class BitStream {
 public:
 
-    BitStream(const uint8_t* data, int length) : m_data(data), m_length(length), m_index(0) {
+    BitStream(const uint8_t* data, int length) : m_data(data), m_length(length), m_index(0), m_cache(0), m_cacheIndex(-1) {
     }
 
     ~BitStream() {}
 
-    int getBit(void);
+    int getBit(void) {
+        return (int)getBits(1);
+    }
+
+    inline uint32_t getBits(int n) {
+        if(n <= 0) {
+            return 0;
+        }
+
+        int offset = m_index - m_cacheIndex;
 
-    uint32_t getBits(int n);
+        if(m_cacheIndex < 0 || offset < 0 || offset + n > 64) {
+            fillCache();
+            offset = m_index - m_cacheIndex;
+        }
+
+        m_index += n;
+        return (uint32_t)((m_cache << offset) >> (64 - n));
+    }
+
+    uint32_t getGolombUe(void);
 
     void byteAlign(void);
 
@@ -78,9 +96,16 @@ public:
 
 private:
 
+    // load 64 bits starting at the byte containing the current index
+    // bits beyond the end of the stream read as 1 (like the bitwise reader did)
+    void fillCache(void);
+
     const uint8_t* m_data;
     int m_length; // in bits
     int m_index; // in bits
+
+    uint64_t m_cache; // 64 bits starting at m_cacheIndex
+    int m_cacheIndex; // in bits (byte aligned), -1 if empty
 };
 
 #endif // ROBOTV_BITSTREAM_H
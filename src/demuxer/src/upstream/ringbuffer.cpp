@@ -26,26 +26,39 @@
  */
 
 #include "ringbuffer.h"
-#include <stdlib.h>
-#include <unistd.h>
+#include "robotvdmx/bufferpool.h"
 #include <string.h>
 
-RingBuffer::RingBuffer(int size, int margin) {
+RingBuffer::RingBuffer(int size, int margin, bool mirrored) {
     m_size = size;
     m_tail = m_head = m_margin = margin;
     m_gotten = 0;
+    m_mirrored = false;
     m_buffer = NULL;
 
-    if(size > 1) {  // 'Size - 1' must not be 0!
-        if(margin <= size / 2) {
-            m_buffer = (uint8_t*)malloc((size_t)size);
-            clear();
-        }
+    if(size <= 1) { // 'Size - 1' must not be 0!
+        return;
+    }
+
+    // a linear buffer needs margin <= size / 2
+    if(!mirrored && margin > size / 2) {
+        return;
     }
+
+    m_buffer = BufferPool::instance().acquire(m_size, mirrored);
+    m_mirrored = mirrored;
+
+    if(!m_mirrored && margin > m_size / 2) {
+        BufferPool::instance().release(m_buffer, m_size, m_mirrored);
+        m_buffer = NULL;
+        return;
+    }
+
+    clear();
 }
 
 RingBuffer::~RingBuffer() {
-    ::free(m_buffer);
+    BufferPool::instance().release(m_buffer, m_size, m_mirrored);
 }
 
 int RingBuffer::onDataReady(const uint8_t* data, int count) {
@@ -54,11 +67,16 @@ int RingBuffer::onDataReady(const uint8_t* data, int count) {
 
 int RingBuffer::available(void) const {
     int diff = m_head - m_tail;
+
+    if(m_mirrored) {
+        return (diff >= 0) ? diff : size() + diff;
+    }
+
     return (diff >= 0) ? diff : size() + diff - m_margin;
 }
 
 void RingBuffer::clear(void) {
-    m_tail = m_head = m_margin;
+    m_tail = m_head = (m_mirrored ? 0 : m_margin);
 }
 
 int RingBuffer::put(const uint8_t *data, int count) {
@@ -66,6 +84,20 @@ int RingBuffer::put(const uint8_t *data, int count) {
         return count;
     }
 
+    // the mirror mapping takes care of the wrap around
+    if(m_mirrored) {
+        int free = size() - available() - 1;
+
+        if(free < count) {
+            count = free > 0 ? free : 0;
+        }
+
+        memcpy(m_buffer + m_head, data, (size_t)count);
+        m_head = (m_head + count) % size();
+
+        return count;
+    }
+
     int Tail = m_tail;
     int rest = size() - m_head;
     int diff = Tail - m_head;
@@ -98,6 +130,18 @@ int RingBuffer::put(const uint8_t *data, int count) {
 }
 
 uint8_t* RingBuffer::get(int &count) {
+    if(m_mirrored) {
+        uint8_t* p = m_buffer + m_tail;
+        int cont = onDataReady(p, available());
+
+        if(cont > 0) {
+            count = m_gotten = cont;
+            return p;
+        }
+
+        return nullptr;
+    }
+
     int Head = m_head;
     int rest = size() - m_tail;
 
@@ -138,6 +182,11 @@ void RingBuffer::del(int count) {
     tail += count;
     m_gotten -= count;
 
+    if(m_mirrored) {
+        m_tail = tail % size();
+        return;
+    }
+
     if(tail >= size()) {
         tail = m_margin;
     }
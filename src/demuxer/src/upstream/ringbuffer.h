@@ -38,6 +38,7 @@ private:
     int m_head;
     int m_tail;
     int m_gotten;
+    bool m_mirrored;
     uint8_t* m_buffer;
 
 protected:
@@ -64,17 +65,29 @@ public:
      * The buffer will be able to hold at most size-margin-1 bytes of data, and will
      * be guaranteed to return at least margin bytes in one consecutive block.
      *
+     * A mirrored ring buffer maps its memory twice in a row (memfd + double mmap),
+     * so every readable and writable span is contiguous without copying. The size
+     * will be rounded up to the page size. If the mapping cannot be created
+     * the buffer falls back to the linear mode.
+     *
+     * The memory is taken from (and returned to) the BufferPool.
+     *
      * @param size total size of the buffer
      * @param margin block size
+     * @param mirrored create a mirrored buffer
      */
-    RingBuffer(int size, int margin = 0);
+    RingBuffer(int size, int margin = 0, bool mirrored = false);
 
     virtual ~RingBuffer();
 
     int available(void) const;
 
     int free(void) const {
-        return size() - available() - 1 - m_margin;
+        return size() - available() - 1 - (m_mirrored ? 0 : m_margin);
+    }
+
+    bool isMirrored() const {
+        return m_mirrored;
     }
 
     /**
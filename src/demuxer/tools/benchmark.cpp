@@ -0,0 +1,530 @@
+/*
+ *      vdr-plugin-robotv - roboTV server plugin for VDR
+ *
+ *      Copyright (C) 2016 Alexander Pipelka
+ *
+ *      https://github.com/pipelka/vdr-plugin-robotv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+/*
+ * robotvdmx-bench: demuxer benchmark
+ *
+ * Feeds a transport stream file through the demuxer and reports the throughput
+ * and the CPU time spent per stream. Optionally writes a frame log
+ * (pid, pts, dts, frame type, size) which can be diffed between two builds and
+ * the video frame index (pid, position, pts, dts, time, frame type, size).
+ *
+ * usage: robotvdmx-bench [-t] [-l logfile] [-i indexfile] file.ts
+ */
+
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "robotvdmx/bufferpool.h"
+#include "robotvdmx/demuxerbundle.h"
+#include "robotvdmx/pes.h"
+
+static int64_t nanoseconds(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Minimal PSI section assembler (PAT / PMT)
+ */
+class SectionReader {
+public:
+
+    // returns true if a complete section is available
+    bool put(const uint8_t* packet) {
+        int offset = TsPayloadOffset(packet);
+
+        if(offset >= TS_SIZE) {
+            return false;
+        }
+
+        const uint8_t* data = packet + offset;
+        int length = TS_SIZE - offset;
+
+        if(TsPayloadStart(packet)) {
+            int pointer = data[0];
+
+            if(pointer + 1 >= length) {
+                return false;
+            }
+
+            m_section.assign(data + 1 + pointer, data + length);
+        }
+        else if(!m_section.empty()) {
+            m_section.insert(m_section.end(), data, data + length);
+        }
+
+        if(m_section.size() < 3) {
+            return false;
+        }
+
+        size_t sectionLength = 3 + (((m_section[1] & 0x0F) << 8) | m_section[2]);
+        return (m_section.size() >= sectionLength);
+    }
+
+    const std::vector<uint8_t>& section() const {
+        return m_section;
+    }
+
+    void clear() {
+        m_section.clear();
+    }
+
+private:
+
+    std::vector<uint8_t> m_section;
+
+};
+
+class Benchmark : public TsDemuxer::Listener {
+public:
+
+    struct PidStats {
+        uint64_t packets = 0;
+        uint64_t frames = 0;
+        uint64_t bytes = 0;
+        int64_t cpuTime = 0;
+    };
+
+    Benchmark(bool threaded, FILE* log, FILE* index) : m_demuxers(this), m_log(log), m_index(index) {
+        m_demuxers.setThreaded(threaded);
+    }
+
+    void processTsPacket(uint8_t* packet, int64_t position) {
+        int pid = TsPid(packet);
+        m_tsPackets++;
+
+        if(pid == 0) {
+            processPat(packet);
+            return;
+        }
+
+        if(pid == m_pmtPid) {
+            processPmt(packet);
+            return;
+        }
+
+        PidStats& stats = m_pidStats[pid];
+        stats.packets++;
+
+        if(m_demuxers.isThreaded()) {
+            // the file is read faster than realtime - don't overflow the stream threads
+            if((m_tsPackets % 256) == 0) {
+                m_demuxers.drain();
+            }
+
+            m_demuxers.processTsPacket(packet, position);
+            return;
+        }
+
+        int64_t start = nanoseconds(CLOCK_THREAD_CPUTIME_ID);
+        m_demuxers.processTsPacket(packet, position);
+        stats.cpuTime += nanoseconds(CLOCK_THREAD_CPUTIME_ID) - start;
+    }
+
+    void flush() {
+        m_demuxers.flush();
+    }
+
+    void report(uint64_t bytes, int64_t wallTime, int64_t cpuTime) {
+        double seconds = (double)wallTime / 1000000000.0;
+
+        printf("\n");
+        printf("bytes:        %" PRIu64 "\n", bytes);
+        printf("TS packets:   %" PRIu64 "\n", m_tsPackets);
+        printf("wall time:    %.3f s\n", seconds);
+        printf("cpu time:     %.3f s\n", (double)cpuTime / 1000000000.0);
+        printf("throughput:   %.2f MB/s\n", seconds > 0 ? (double)bytes / seconds / 1000000.0 : 0);
+        printf("packets/s:    %.0f\n", seconds > 0 ? (double)m_tsPackets / seconds : 0);
+        printf("lost packets: %" PRIu64 "\n", m_demuxers.getLostPackets());
+
+        BufferPool::Statistics pool = BufferPool::instance().getStatistics();
+        printf("buffer pool:  %" PRIu64 " hits, %" PRIu64 " misses, %zu in use, %zu pooled (%zu KB)\n",
+               pool.hits, pool.misses, pool.used, pool.buffers, pool.bytes / 1024);
+        printf("\n");
+
+        printf("%6s %-12s %10s %10s %10s %12s %10s\n", "pid", "type", "packets", "lost", "frames", "bytes", "cpu (ms)");
+
+        for(auto& i : m_pidStats) {
+            TsDemuxer* demuxer = m_demuxers.findDemuxer(i.first);
+
+            if(demuxer == nullptr) {
+                continue;
+            }
+
+            printf("%6i %-12s %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %12" PRIu64 " %10.1f\n",
+                   i.first,
+                   StreamInfo::typeName(demuxer->getType()),
+                   i.second.packets,
+                   demuxer->getLostPackets(),
+                   i.second.frames,
+                   i.second.bytes,
+                   (double)i.second.cpuTime / 1000000.0);
+        }
+
+        printf("\n");
+
+        for(auto i : m_demuxers) {
+            printf("%s\n", i->info().c_str());
+        }
+    }
+
+protected:
+
+    void onStreamPacket(TsDemuxer::StreamPacket* p) {
+        PidStats& stats = m_pidStats[(int)p->pid];
+        stats.frames++;
+        stats.bytes += p->size;
+
+        if(m_log != nullptr) {
+            fprintf(m_log, "%" PRId64 " %" PRId64 " %" PRId64 " %i %i\n", p->pid, p->pts, p->dts, (int)p->frameType, p->size);
+        }
+    }
+
+    void onStreamChange() {
+    }
+
+    void onFrameIndex(TsDemuxer::FrameIndex* index) {
+        if(m_index != nullptr) {
+            fprintf(m_index, "%" PRId64 " %" PRId64 " %" PRId64 " %" PRId64 " %" PRId64 " %i %i\n", index->pid, index->position, index->pts, index->dts, index->time, (int)index->frameType, index->size);
+        }
+    }
+
+private:
+
+    void processPat(uint8_t* packet) {
+        if(!m_pat.put(packet)) {
+            return;
+        }
+
+        const std::vector<uint8_t>& s = m_pat.section();
+        int length = 3 + (((s[1] & 0x0F) << 8) | s[2]) - 4; // without CRC
+
+        // first program
+        for(int i = 8; i + 4 <= length; i += 4) {
+            int program = (s[i] << 8) | s[i + 1];
+
+            if(program != 0) {
+                m_pmtPid = ((s[i + 2] & 0x1F) << 8) | s[i + 3];
+                break;
+            }
+        }
+
+        m_pat.clear();
+    }
+
+    void processPmt(uint8_t* packet) {
+        if(!m_pmt.put(packet)) {
+            return;
+        }
+
+        const std::vector<uint8_t>& s = m_pmt.section();
+        int version = (s[5] >> 1) & 0x1F;
+        int length = 3 + (((s[1] & 0x0F) << 8) | s[2]) - 4; // without CRC
+
+        if(version == m_pmtVersion || s[0] != 0x02) {
+            m_pmt.clear();
+            return;
+        }
+
+        m_pmtVersion = version;
+
+        StreamBundle bundle;
+        int i = 12 + (((s[10] & 0x0F) << 8) | s[11]);
+
+        while(i + 5 <= length) {
+            int streamType = s[i];
+            int pid = ((s[i + 1] & 0x1F) << 8) | s[i + 2];
+            int esInfoLength = ((s[i + 3] & 0x0F) << 8) | s[i + 4];
+
+            addStream(bundle, streamType, pid, &s[i + 5], std::min(esInfoLength, length - i - 5));
+            i += 5 + esInfoLength;
+        }
+
+        m_demuxers.updateFrom(&bundle);
+        m_pmt.clear();
+    }
+
+    void addStream(StreamBundle& bundle, int streamType, int pid, const uint8_t* descriptors, int length) {
+        StreamInfo::Type type = StreamInfo::Type::NONE;
+        std::string lang;
+        const uint8_t* subtitling = nullptr;
+
+        switch(streamType) {
+            case 0x01:
+            case 0x02:
+                type = StreamInfo::Type::MPEG2VIDEO;
+                break;
+
+            case 0x1b:
+                type = StreamInfo::Type::H264;
+                break;
+
+            case 0x24:
+                type = StreamInfo::Type::H265;
+                break;
+
+            case 0x03:
+            case 0x04:
+                type = StreamInfo::Type::MPEG2AUDIO;
+                break;
+
+            case 0x0f:
+                type = StreamInfo::Type::AAC;
+                break;
+
+            case 0x11:
+                type = StreamInfo::Type::LATM;
+                break;
+
+            case 0x81:
+                type = StreamInfo::Type::AC3;
+                break;
+
+            case 0x87:
+                type = StreamInfo::Type::EAC3;
+                break;
+
+            default:
+                break;
+        }
+
+        // walk descriptors
+        for(int i = 0; i + 2 <= length; i += 2 + descriptors[i + 1]) {
+            int tag = descriptors[i];
+            int size = descriptors[i + 1];
+            const uint8_t* d = &descriptors[i + 2];
+
+            if(i + 2 + size > length) {
+                break;
+            }
+
+            switch(tag) {
+                case 0x0A: // ISO 639 language
+                case 0x56: // teletext
+                    if(size >= 3) {
+                        lang.assign((const char*)d, 3);
+                    }
+
+                    if(tag == 0x56 && streamType == 0x06) {
+                        type = StreamInfo::Type::TELETEXT;
+                    }
+
+                    break;
+
+                case 0x59: // subtitling
+                    if(size >= 8 && streamType == 0x06) {
+                        lang.assign((const char*)d, 3);
+                        type = StreamInfo::Type::DVBSUB;
+                        subtitling = d;
+                    }
+
+                    break;
+
+                case 0x6A: // AC3
+                    if(streamType == 0x06) {
+                        type = StreamInfo::Type::AC3;
+                    }
+
+                    break;
+
+                case 0x7A: // EAC3
+                    if(streamType == 0x06) {
+                        type = StreamInfo::Type::EAC3;
+                    }
+
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        if(type == StreamInfo::Type::NONE) {
+            return;
+        }
+
+        StreamInfo stream(pid, type, lang.empty() ? nullptr : lang.c_str());
+
+        if(subtitling != nullptr) {
+            stream.setSubtitlingDescriptor(
+                subtitling[3],
+                (subtitling[4] << 8) | subtitling[5],
+                (subtitling[6] << 8) | subtitling[7]);
+        }
+
+        bundle.addStream(stream);
+    }
+
+    DemuxerBundle m_demuxers;
+
+    FILE* m_log;
+
+    FILE* m_index;
+
+    SectionReader m_pat;
+
+    SectionReader m_pmt;
+
+    int m_pmtPid = -1;
+
+    int m_pmtVersion = -1;
+
+    uint64_t m_tsPackets = 0;
+
+    std::map<int, PidStats> m_pidStats;
+
+};
+
+static void usage(const char* name) {
+    fprintf(stderr, "usage: %s [-t] [-l logfile] [-i indexfile] file.ts\n", name);
+    fprintf(stderr, "  -t            threaded demuxer\n");
+    fprintf(stderr, "  -l logfile    write frame log (pid pts dts frametype size), '-' for stdout\n");
+    fprintf(stderr, "  -i indexfile  write video frame index (pid position pts dts time frametype size)\n");
+}
+
+int main(int argc, char* argv[]) {
+    bool threaded = false;
+    const char* logFile = nullptr;
+    const char* indexFile = nullptr;
+    int c;
+
+    while((c = getopt(argc, argv, "tl:i:h")) != -1) {
+        switch(c) {
+            case 't':
+                threaded = true;
+                break;
+
+            case 'l':
+                logFile = optarg;
+                break;
+
+            case 'i':
+                indexFile = optarg;
+                break;
+
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if(optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE* in = fopen(argv[optind], "rb");
+
+    if(in == nullptr) {
+        fprintf(stderr, "unable to open '%s'\n", argv[optind]);
+        return 1;
+    }
+
+    FILE* log = nullptr;
+
+    if(logFile != nullptr) {
+        log = (strcmp(logFile, "-") == 0) ? stdout : fopen(logFile, "w");
+
+        if(log == nullptr) {
+            fprintf(stderr, "unable to create '%s'\n", logFile);
+            fclose(in);
+            return 1;
+        }
+    }
+
+    FILE* index = nullptr;
+
+    if(indexFile != nullptr) {
+        index = fopen(indexFile, "w");
+
+        if(index == nullptr) {
+            fprintf(stderr, "unable to create '%s'\n", indexFile);
+            fclose(in);
+            return 1;
+        }
+    }
+
+    Benchmark benchmark(threaded, log, index);
+
+    std::vector<uint8_t> buffer(TS_SIZE * 1024);
+    uint64_t bytes = 0;
+    size_t rest = 0;
+
+    int64_t wallStart = nanoseconds(CLOCK_MONOTONIC);
+    int64_t cpuStart = nanoseconds(CLOCK_PROCESS_CPUTIME_ID);
+
+    for(;;) {
+        size_t length = rest + fread(buffer.data() + rest, 1, buffer.size() - rest, in);
+
+        if(length == rest) {
+            break;
+        }
+
+        size_t i = 0;
+
+        while(i + TS_SIZE <= length) {
+            // resync
+            if(buffer[i] != 0x47) {
+                i++;
+                continue;
+            }
+
+            benchmark.processTsPacket(&buffer[i], (int64_t)(bytes + i));
+            i += TS_SIZE;
+        }
+
+        rest = length - i;
+        memmove(buffer.data(), buffer.data() + i, rest);
+        bytes += i;
+    }
+
+    benchmark.flush();
+
+    int64_t wallTime = nanoseconds(CLOCK_MONOTONIC) - wallStart;
+    int64_t cpuTime = nanoseconds(CLOCK_PROCESS_CPUTIME_ID) - cpuStart;
+
+    fclose(in);
+
+    if(log != nullptr && log != stdout) {
+        fclose(log);
+    }
+
+    if(index != nullptr) {
+        fclose(index);
+    }
+
+    benchmark.report(bytes, wallTime, cpuTime);
+    return 0;
+}
@@ -26,7 +26,7 @@
 #include "channelcache.h"
 #include "tools/hash.h"
 
-ChannelCache::ChannelCache() {
+ChannelCache::ChannelCache(const char* table) : m_table(table) {
     createDb();
 }
 
@@ -35,13 +35,18 @@ ChannelCache& ChannelCache::instance() {
     return cache;
 }
 
+ChannelCache& ChannelCache::recordingInstance() {
+    static ChannelCache cache("recordingcache");
+    return cache;
+}
+
 void ChannelCache::gc() {
     // TODO - implement garbage collection
 }
 
 void ChannelCache::createDb() {
     std::string schema =
-        "CREATE TABLE IF NOT EXISTS channelcache (\n"
+        "CREATE TABLE IF NOT EXISTS " + m_table + " (\n"
         "  channeluid INT NOT NULL,\n"
         "  pid INT NOT NULL,\n"
         "  content INT NOT NULL,\n"
@@ -65,7 +70,7 @@ void ChannelCache::createDb() {
         "  vps BLOB,\n"
         "  PRIMARY KEY (channeluid, pid)"
         ");\n"
-        "CREATE INDEX IF NOT EXISTS channelcache_channeluid ON channelcache(channeluid);\n"
+        "CREATE INDEX IF NOT EXISTS " + m_table + "_channeluid ON " + m_table + "(channeluid);\n"
         "CREATE TABLE IF NOT EXISTS enabledchannels (\n"
         "  channeluid INT NOT NULL,\n"
         "  enabled INT DEFAULT 0 NOT NULL,\n"
@@ -73,11 +78,11 @@ void ChannelCache::createDb() {
         ");\n";
 
     if(exec(schema) != SQLITE_OK) {
-        esyslog("Unable to create database schema for channelcache");
+        esyslog("Unable to create database schema for %s", m_table.c_str());
     }
 }
 
-std::string ChannelCache::createStringLiteral(uint8_t* data, int length) {
+std::string ChannelCache::createStringLiteral(const uint8_t* data, int length) {
     char buffer[3];
     std::string literal;
 
@@ -102,13 +107,21 @@ void ChannelCache::addDb(uint32_t channeluid, const StreamBundle& channel) {
 
     storage.begin();
 
-    storage.exec("DELETE FROM channelcache WHERE channeluid=%i", channeluid);
+    storage.exec("DELETE FROM %s WHERE channeluid=%i", m_table.c_str(), channeluid);
+
+    for(auto& i : channel) {
+        const StreamInfo& info = i.second;
 
-    for(auto i : channel) {
-        StreamInfo& info = i.second;
+        int spsLength = 0;
+        int ppsLength = 0;
+        int vpsLength = 0;
+
+        const uint8_t* sps = info.getVideoDecoderSps(spsLength);
+        const uint8_t* pps = info.getVideoDecoderPps(ppsLength);
+        const uint8_t* vps = info.getVideoDecoderVps(vpsLength);
 
         storage.exec(
-            "INSERT INTO channelcache("
+            "INSERT INTO %s("
             "channeluid,"
             "pid,"
             "content,"
@@ -133,6 +146,7 @@ void ChannelCache::addDb(uint32_t channeluid, const StreamBundle& channel) {
             "VALUES ("
             "%i,%i,%i,%i,%Q,%i,%i,%i,%i,%i,%i,%i,%i,%i,%i,%i,%i,%i,x'%s',x'%s',x'%s'"
             ")",
+            m_table.c_str(),
             channeluid,
             info.m_pid,
             (int)info.m_content,
@@ -151,9 +165,9 @@ void ChannelCache::addDb(uint32_t channeluid, const StreamBundle& channel) {
             info.m_subTitlingType,
             info.m_compositionPageId,
             info.m_ancillaryPageId,
-            createStringLiteral(info.m_sps, info.m_spsLength).c_str(),
-            createStringLiteral(info.m_pps, info.m_ppsLength).c_str(),
-            createStringLiteral(info.m_vps, info.m_vpsLength).c_str()
+            createStringLiteral(sps, spsLength).c_str(),
+            createStringLiteral(pps, ppsLength).c_str(),
+            createStringLiteral(vps, vpsLength).c_str()
         );
     }
 
@@ -184,9 +198,10 @@ StreamBundle ChannelCache::lookup(uint32_t channeluid) {
                           "  pps,"
                           "  vps "
                           "FROM "
-                          "  channelcache "
+                          "  %s "
                           "WHERE"
                           "  channeluid=%i",
+                          m_table.c_str(),
                           channeluid
                       );
 
@@ -216,16 +231,14 @@ StreamBundle ChannelCache::lookup(uint32_t channeluid) {
         info.m_compositionPageId = sqlite3_column_int(s, 15);
         info.m_ancillaryPageId = sqlite3_column_int(s, 16);
 
-        info.m_spsLength = sqlite3_column_bytes(s, 17);
-        memcpy(info.m_sps, sqlite3_column_text(s, 17), info.m_spsLength);
-
-        info.m_ppsLength = sqlite3_column_bytes(s, 18);
-        memcpy(info.m_pps, sqlite3_column_text(s, 18), info.m_ppsLength);
-
-        info.m_vpsLength = sqlite3_column_bytes(s, 19);
-        memcpy(info.m_vps, sqlite3_column_text(s, 19), info.m_vpsLength);
+        if(info.m_content == StreamInfo::Content::VIDEO) {
+            info.setVideoDecoderData(
+                (const uint8_t*)sqlite3_column_blob(s, 17), sqlite3_column_bytes(s, 17),
+                (const uint8_t*)sqlite3_column_blob(s, 18), sqlite3_column_bytes(s, 18),
+                (const uint8_t*)sqlite3_column_blob(s, 19), sqlite3_column_bytes(s, 19));
+        }
 
-        bundle.addStream(info);
+        bundle.addStream(std::move(info));
     }
 
     sqlite3_finalize(s);
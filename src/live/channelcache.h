@@ -52,9 +52,12 @@ public:
 
     static ChannelCache& instance();
 
+    // stream cache of recordings (keyed by recording id)
+    static ChannelCache& recordingInstance();
+
 protected:
 
-    ChannelCache();
+    ChannelCache(const char* table = "channelcache");
 
 private:
 
@@ -62,7 +65,9 @@ private:
 
     void createDb();
 
-    std::string createStringLiteral(uint8_t* data, int length);
+    std::string createStringLiteral(const uint8_t* data, int length);
+
+    std::string m_table;
 
 };
 
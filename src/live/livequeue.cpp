@@ -27,6 +27,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <cstring>
+#include <algorithm>
 
 #include "config/config.h"
 #include "net/msgpacket.h"
@@ -343,40 +344,27 @@ int64_t LiveQueue::seek(int64_t wallclockPositionMs) {
 
     isyslog("seek: %lu", wallclockPositionMs);
 
-    auto s = m_indexList.rbegin();
-    auto e = m_indexList.rend();
-    auto h = m_indexList.begin();
-
-    if(s == e) {
+    if(m_indexList.empty()) {
         esyslog("empty timeshift queue - unable to seek");
         return 0;
     }
 
-    // ahead of buffer
-    if(wallclockPositionMs >= s->wallclockTime.count()) {
-        lseek(m_readFd, s->filePosition, SEEK_SET);
-        return s->pts;
-    }
+    // last keyframe at or before the requested position
+    auto i = std::upper_bound(
+                 m_indexList.begin(),
+                 m_indexList.end(),
+                 wallclockPositionMs,
+                 [](int64_t position, const PacketIndex& index) {
+                     return position < index.wallclockTime.count();
+                 });
 
     // behind buffer
-    else if(wallclockPositionMs <= h->wallclockTime.count()) {
-        lseek(m_readFd, h->filePosition, SEEK_SET);
-        return h->pts;
-    }
-
-    // in between ?
-    while(s != e) {
-        if(s->wallclockTime.count() <= wallclockPositionMs) {
-            lseek(m_readFd, s->filePosition, SEEK_SET);
-            return s->pts;
-        }
-
-        s++;
+    if(i != m_indexList.begin()) {
+        i--;
     }
 
-    // not found
-    esyslog("fileposition not found!");
-    return 0;
+    lseek(m_readFd, i->filePosition, SEEK_SET);
+    return i->pts;
 }
 
 int64_t LiveQueue::getTimeshiftStartPosition() {
@@ -23,6 +23,7 @@
  */
 
 #include <stdlib.h>
+#include <algorithm>
 #include <vdr/remux.h>
 #include <vdr/timers.h>
 
@@ -33,6 +34,7 @@
 #endif
 
 #include "config/config.h"
+#include "robotvdmx/bufferpool.h"
 #include "net/msgpacket.h"
 #include "robotv/robotvcommand.h"
 #include "robotv/robotvclient.h"
@@ -53,9 +55,12 @@ using namespace std::chrono;
 LiveStreamer::LiveStreamer(RoboTvClient* parent, int priority)
     : cReceiver(nullptr, priority)
     , m_parent(parent)
-    , m_uid(0) {
+    , m_uid(0)
+    , m_selectionChanged(false) {
     // create send queue
     m_queue = new LiveQueue(m_parent->getSocket());
+
+    getDemuxers().setThreaded(RoboTVServerConfig::instance().threadedDemuxer);
 }
 
 LiveStreamer::~LiveStreamer() {
@@ -180,6 +185,9 @@ MsgPacket *LiveStreamer::createStreamChangePacket(DemuxerBundle &bundle) {
     // reorder streams as preferred
     bundle.reorderStreams(m_language.c_str(), m_langStreamType);
 
+    // apply the client selection to new streams
+    m_selectionChanged = true;
+
     return StreamPacketProcessor::createStreamChangePacket(bundle);
 }
 
@@ -333,7 +341,34 @@ MsgPacket* LiveStreamer::requestPacket() {
 }
 
 void LiveStreamer::Receive(const uchar* packet, int length) {
-    putTsPacket((uint8_t*)packet, roboTV::currentTimeMillis().count());
+    if(m_selectionChanged) {
+        applyStreamSelection();
+    }
+
+    putTsPacket((uint8_t*)packet);
+}
+
+void LiveStreamer::selectStream(int pid, bool enabled) {
+    std::lock_guard<std::mutex> lock(m_selectMutex);
+
+    m_selectedStreams[pid] = enabled;
+    m_selectionChanged = true;
+}
+
+void LiveStreamer::applyStreamSelection() {
+    std::lock_guard<std::mutex> lock(m_selectMutex);
+    DemuxerBundle& demuxers = getDemuxers();
+
+    // the preferred streams come first
+    demuxers.reorderStreams(m_language.c_str(), m_langStreamType);
+
+    // every stream is demuxed unless the client disabled it
+    for(auto i : demuxers) {
+        auto s = m_selectedStreams.find(i->getPid());
+        demuxers.setEnabled(i->getPid(), s == m_selectedStreams.end() || s->second);
+    }
+
+    m_selectionChanged = false;
 }
 
 void LiveStreamer::processChannelChange(const cChannel* channel) {
@@ -362,6 +397,15 @@ void LiveStreamer::createDemuxers(StreamBundle* bundle) {
         TsDemuxer* dmx = *i;
         AddPid(dmx->getPid());
     }
+
+    // keep the stream selection of the client
+    m_selectionChanged = true;
+
+    BufferPool::Statistics stats = BufferPool::instance().getStatistics();
+    uint64_t total = stats.hits + stats.misses;
+
+    dsyslog("parser buffers: %zu in use, %zu pooled (%zu KB), hit rate %i%%",
+            stats.used, stats.buffers, stats.bytes / 1024, total > 0 ? (int)(stats.hits * 100 / total) : 0);
 }
 
 int64_t LiveStreamer::seek(int64_t wallclockPositionMs) {
@@ -426,7 +470,24 @@ StreamBundle LiveStreamer::createFromChannel(const cChannel* channel) {
 }
 
 int64_t LiveStreamer::getCurrentTime(TsDemuxer::StreamPacket *p) {
-    return p->streamPosition;
+    if(p->time == DVD_NOPTS_VALUE) {
+        return (m_lastWallclock != 0) ? m_lastWallclock : roboTV::currentTimeMillis().count();
+    }
+
+    int64_t elapsed = p->time - m_anchorTime;
+
+    // anchor the stream timeline to the wallclock once per second
+    // (or after a timeline restart)
+    if(m_anchorTime == DVD_NOPTS_VALUE || elapsed < -90000 || elapsed >= 90000) {
+        m_anchorTime = p->time;
+        m_anchorWallclock = std::max<int64_t>(roboTV::currentTimeMillis().count(), m_lastWallclock);
+        elapsed = 0;
+    }
+
+    // never go back in time
+    m_lastWallclock = std::max<int64_t>(m_anchorWallclock + elapsed / 90, m_lastWallclock);
+
+    return m_lastWallclock;
 }
 
 void LiveStreamer::onPacket(MsgPacket *p, StreamInfo::Content content, int64_t pts) {
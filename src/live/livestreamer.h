@@ -37,7 +37,9 @@
 #include "robotv/robotvcommand.h"
 #include "livequeue.h"
 
+#include <atomic>
 #include <list>
+#include <map>
 #include <mutex>
 #include <robotv/StreamPacketProcessor.h>
 
@@ -65,6 +67,18 @@ private:
 
     MsgPacket* m_streamPacket = NULL;
 
+    int64_t m_anchorTime = DVD_NOPTS_VALUE; // stream time of the wallclock anchor (90kHz)
+
+    int64_t m_anchorWallclock = 0; // wallclock of the anchor (ms)
+
+    int64_t m_lastWallclock = 0; // last packet wallclock time (ms)
+
+    std::mutex m_selectMutex;
+
+    std::map<int, bool> m_selectedStreams; // pending stream selections (pid / enabled)
+
+    std::atomic<bool> m_selectionChanged;
+
 protected:
 
 #if VDRVERSNUM < 20300
@@ -85,6 +99,8 @@ private:
 
     void createDemuxers(StreamBundle* bundle);
 
+    void applyStreamSelection();
+
 public:
 
     LiveStreamer(RoboTvClient* parent, int priority);
@@ -107,6 +123,9 @@ public:
 
     int64_t seek(int64_t wallclockPositionMs);
 
+    // enable / disable a stream (applied by the receiver thread)
+    void selectStream(int pid, bool enabled);
+
 };
 
 #endif  // ROBOTV_RECEIVER_H
@@ -22,23 +22,55 @@
  *
  */
 
+#include <algorithm>
+#include <limits>
 #include <live/livestreamer.h>
 #include <tools/time.h>
+#include <tools/hash.h>
+#include "live/channelcache.h"
+#include "recordingscache.h"
+#include "robotv/robotvcommand.h"
 #include "packetplayer.h"
 
 #define MIN_PACKET_SIZE (128 * 1024)
 
-PacketPlayer::PacketPlayer(const cRecording* rec) : RecPlayer(rec->FileName()) {
-    m_index = new cIndexFile(rec->FileName(), false);
-    m_recording = rec;
+// interval of the recording length update (stream time, 90kHz)
+#define UPDATE_INTERVAL (10 * 90000)
+
+// pictures per second in trick play mode
+#define TRICKPLAY_FPS 5
+
+// maximum size of an I-Frame read in trick play mode
+#define MAX_IFRAME_SIZE (4 * 1024 * 1024)
+
+PacketPlayer::PacketPlayer(const cRecording* rec) :
+    PacketPlayer(rec->FileName(), rec->FramesPerSecond(), rec->IsPesRecording()) {
+}
+
+PacketPlayer::PacketPlayer(const char* fileName, double framesPerSecond, bool isPesRecording) :
+    RecPlayer(fileName), m_fileName(fileName), m_framesPerSecond(framesPerSecond), m_isPesRecording(isPesRecording) {
+    m_index = new cIndexFile(fileName, false);
     m_position = 0;
+    m_uid = roboTV::Hash::createStringHash(fileName);
 
-    // initial start / end time
-    m_startTime = std::chrono::milliseconds(0);
-    m_endTime = std::chrono::milliseconds(0);
+    // start / end time
+    m_startTime = roboTV::currentTimeMillis();
+    m_lengthMs = recordingLength();
+    m_endTime = m_startTime + std::chrono::milliseconds(m_lengthMs);
 
     // allocate buffer
     m_buffer = (uint8_t*)malloc(TS_SIZE * maxPacketCount);
+
+    // time reference of the recording
+    if(!RecordingsCache::instance().getFirstDts(m_uid, m_firstDts)) {
+        m_firstDts = timestampFromPosition(0, true);
+
+        if(m_firstDts != DVD_NOPTS_VALUE) {
+            RecordingsCache::instance().setFirstDts(m_uid, m_firstDts);
+        }
+    }
+
+    createDemuxers();
 }
 
 PacketPlayer::~PacketPlayer() {
@@ -47,23 +79,91 @@ PacketPlayer::~PacketPlayer() {
     delete m_index;
 }
 
+void PacketPlayer::createDemuxers() {
+    StreamBundle bundle = ChannelCache::recordingInstance().lookup(m_uid);
+
+    // streams will be discovered from the PMT
+    if(bundle.empty()) {
+        return;
+    }
+
+    dsyslog("PacketPlayer: stream information found in cache");
+    getDemuxers().updateFrom(&bundle);
+}
+
+int64_t PacketPlayer::recordingLength() {
+    // the index file may still grow
+    if(m_index == nullptr || !m_index->Ok() || m_framesPerSecond <= 0) {
+        return 0;
+    }
+
+    return (int64_t)((m_index->Last() + 1) * 1000 / m_framesPerSecond);
+}
+
+MsgPacket* PacketPlayer::createStreamChangePacket(DemuxerBundle& bundle) {
+    StreamBundle cache;
+
+    for(auto i = bundle.begin(); i != bundle.end(); i++) {
+        cache.addStream(*(*i));
+    }
+
+    ChannelCache::recordingInstance().add(m_uid, cache);
+
+    return StreamPacketProcessor::createStreamChangePacket(bundle);
+}
+
 void PacketPlayer::onPacket(MsgPacket* p, StreamInfo::Content content, int64_t pts) {
     m_queue.push_back(p);
 }
 
 int64_t PacketPlayer::getCurrentTime(TsDemuxer::StreamPacket *p) {
-    // recheck recording duration
-    if((p->frameType == StreamInfo::FrameType::IFRAME) || endTime().count() == 0) {
-        if(startTime().count() == 0) {
-            m_startTime = roboTV::currentTimeMillis();
+    // trick play - wallclock time of the current I-Frame
+    if(m_trickSpeed != 0) {
+        m_currentTime = m_startTime.count() + (int64_t)(m_trickFrame * 1000 / m_framesPerSecond);
+    }
+    else {
+        m_currentTime = getStreamTime(p);
+    }
+
+    return m_currentTime;
+}
+
+int64_t PacketPlayer::getStreamTime(TsDemuxer::StreamPacket *p) {
+    // recheck recording duration (the recording may still grow)
+    bool updateLength = (m_lengthMs == 0);
+
+    if(p->frameType == StreamInfo::FrameType::IFRAME && p->dts != DVD_NOPTS_VALUE) {
+        if(m_lastUpdateDts == DVD_NOPTS_VALUE || ((p->dts - m_lastUpdateDts) & MAX33BIT) >= UPDATE_INTERVAL) {
+            m_lastUpdateDts = p->dts;
+            updateLength = true;
         }
+    }
 
+    if(updateLength) {
         update();
-        m_endTime = m_startTime + std::chrono::milliseconds(m_recording->LengthInSeconds() * 1000);
+        m_lengthMs = recordingLength();
+        m_endTime = m_startTime + std::chrono::milliseconds(m_lengthMs);
+    }
+
+    // the first timestamp of the recording is the time reference
+    if(m_firstDts == DVD_NOPTS_VALUE && m_position <= maxPacketCount * TS_SIZE && p->dts != DVD_NOPTS_VALUE) {
+        m_firstDts = p->dts;
+        RecordingsCache::instance().setFirstDts(m_uid, m_firstDts);
+    }
+
+    // no time reference - interpolate by file position
+    if(m_firstDts == DVD_NOPTS_VALUE || p->dts == DVD_NOPTS_VALUE) {
+        return m_startTime.count() + (m_lengthMs * p->streamPosition) / m_totalLength;
     }
 
-    int64_t durationMs = (m_recording->LengthInSeconds() * 1000 * p->streamPosition) / m_totalLength;
-    return m_startTime.count() + durationMs;
+    int64_t duration = (p->dts - m_firstDts) & MAX33BIT;
+
+    // slightly ahead of the first timestamp (e.g. audio)
+    if(duration > MAX33BIT - UPDATE_INTERVAL) {
+        duration = 0;
+    }
+
+    return m_startTime.count() + duration / 90;
 }
 
 MsgPacket* PacketPlayer::getNextPacket() {
@@ -77,9 +177,15 @@ MsgPacket* PacketPlayer::getNextPacket() {
     }
 
     unsigned char* p = m_buffer;
+    int length = maxPacketCount * TS_SIZE;
+
+    // jump across cut out segments
+    if(skipCut(length)) {
+        return nullptr;
+    }
 
     // get next block (TS packets)
-    int bytesRead = getBlock(p, m_position, maxPacketCount * TS_SIZE);
+    int bytesRead = getBlock(p, m_position, length);
 
     // TS sync
     int offset = 0;
@@ -120,7 +226,178 @@ MsgPacket* PacketPlayer::getNextPacket() {
     return nullptr;
 }
 
+bool PacketPlayer::skipCut(int& length) {
+    for(const auto& cut : m_cuts) {
+        if(m_position >= cut.end) {
+            continue;
+        }
+
+        // don't read into the next cut
+        if(m_position < cut.start) {
+            length = (int)std::min<int64_t>(length, cut.start - m_position);
+            return false;
+        }
+
+        dsyslog("PacketPlayer: skipping marked segment (%ld - %ld)", cut.start, cut.end);
+
+        // deliver the pending frames of the current scene
+        getDemuxers().flush();
+        m_position = cut.end;
+
+        return true;
+    }
+
+    return false;
+}
+
+void PacketPlayer::onStreamPacket(TsDemuxer::StreamPacket* p) {
+    // preview extraction - keep the first I-Frame
+    if(m_previewMode) {
+        if(p->content == StreamInfo::Content::VIDEO && p->frameType == StreamInfo::FrameType::IFRAME && m_preview.empty()) {
+            m_preview.assign(p->data, p->data + p->size);
+        }
+
+        return;
+    }
+
+    if(m_trickSpeed == 0) {
+        if(p->content == StreamInfo::Content::VIDEO && p->pts != DVD_NOPTS_VALUE) {
+            m_lastPts = p->pts;
+        }
+
+        StreamPacketProcessor::onStreamPacket(p);
+        return;
+    }
+
+    // trick play - I-Frames only
+    if(p->content != StreamInfo::Content::VIDEO || p->frameType != StreamInfo::FrameType::IFRAME) {
+        return;
+    }
+
+    // continuous timestamps at the trick play rate
+    int64_t duration = 90000 / TRICKPLAY_FPS;
+    m_lastPts = (m_lastPts + duration) & MAX33BIT;
+
+    p->pts = m_lastPts;
+    p->dts = m_lastPts;
+    p->duration = duration;
+
+    StreamPacketProcessor::onStreamPacket(p);
+}
+
+int PacketPlayer::findIFrame(int frame, bool forward, int64_t& position, int& length) {
+    uint16_t fileNumber = 0;
+    off_t fileOffset = 0;
+
+    // the search starts at the next frame
+    frame = m_index->GetNextIFrame(forward ? frame - 1 : frame + 1, forward, &fileNumber, &fileOffset, &length);
+
+    // start / end of recording reached
+    if(frame < 0) {
+        return -1;
+    }
+
+    int segment = fileNumber - 1;
+
+    if(segment < 0 || segment >= (int)m_segments.size()) {
+        return -1;
+    }
+
+    position = m_segments[segment].start + fileOffset;
+
+    // length unknown - read up to the end of the segment
+    if(length < 0 || length > MAX_IFRAME_SIZE) {
+        length = (int)std::min<int64_t>(m_segments[segment].end - position, MAX_IFRAME_SIZE);
+    }
+
+    return frame;
+}
+
+void PacketPlayer::demuxFrame(int64_t position, int length) {
+    m_position = position;
+
+    // demux the I-Frame (it starts with PAT / PMT)
+    int64_t end = position + length;
+
+    while(position < end) {
+        // random access - read the frame only
+        int bytesRead = getBlock(m_buffer, position, std::min<int64_t>(end - position, maxPacketCount * TS_SIZE), false);
+        int count = bytesRead / TS_SIZE;
+
+        if(count == 0) {
+            break;
+        }
+
+        for(int i = 0; i < count; i++) {
+            putTsPacket(m_buffer + i * TS_SIZE, position + (i + 1) * TS_SIZE);
+        }
+
+        position += count * TS_SIZE;
+    }
+
+    getDemuxers().flush();
+}
+
+int PacketPlayer::demuxIFrame(int frame, bool forward) {
+    int64_t position = 0;
+    int length = 0;
+
+    frame = findIFrame(frame, forward, position, length);
+
+    if(frame < 0) {
+        return -1;
+    }
+
+    demuxFrame(position, length);
+    return frame;
+}
+
+bool PacketPlayer::getTrickPlayFrame() {
+    // the target advances at the trick play speed
+    m_trickTarget += m_trickSpeed * m_framesPerSecond / TRICKPLAY_FPS;
+
+    if(m_trickTarget < 0 || m_trickTarget > m_index->Last()) {
+        return false;
+    }
+
+    // next I-Frame in playback direction
+    int64_t position = 0;
+    int length = 0;
+    int frame = findIFrame((int)m_trickTarget, m_trickSpeed > 0, position, length);
+
+    if(frame < 0) {
+        return false;
+    }
+
+    // still the same picture - keep it for this interval
+    if(frame == m_trickFrame) {
+        m_lastPts = (m_lastPts + 90000 / TRICKPLAY_FPS) & MAX33BIT;
+        return true;
+    }
+
+    m_trickFrame = frame;
+    demuxFrame(position, length);
+
+    return true;
+}
+
 MsgPacket* PacketPlayer::getPacket() {
+    if(m_trickSpeed != 0) {
+        // don't walk through the whole recording if nothing drops out
+        for(int i = 0; m_queue.empty() && i < TRICKPLAY_FPS; i++) {
+            if(!getTrickPlayFrame()) {
+                break;
+            }
+        }
+
+        return m_queue.empty() ? nullptr : getNextPacket();
+    }
+
+    // the recording may still grow
+    if(m_position >= m_totalLength) {
+        update();
+    }
+
     if(m_position >= m_totalLength) {
         dsyslog("PacketPlayer: end of file reached (position=%ld / total=%ld)", m_position, m_totalLength);
         // TODO - send end of stream packet
@@ -189,6 +466,7 @@ void PacketPlayer::clearQueue() {
 
 void PacketPlayer::reset() {
     StreamPacketProcessor::reset();
+    createDemuxers();
 
     // reset current stream packet
     delete m_streamPacket;
@@ -205,23 +483,301 @@ int64_t PacketPlayer::filePositionFromClock(int64_t wallclockTimeMs) {
     return (m_totalLength * durationSinceStartMs) / durationMs;
 }
 
+int PacketPlayer::frameFromClock(int64_t wallclockTimeMs) {
+    int64_t durationSinceStartMs = wallclockTimeMs - startTime().count();
+    int frame = (int)((durationSinceStartMs * m_framesPerSecond) / 1000);
+
+    if(frame < 0) {
+        frame = 0;
+    }
+
+    if(frame > m_index->Last()) {
+        frame = m_index->Last();
+    }
+
+    return frame;
+}
+
+int64_t PacketPlayer::filePositionFromIndex(int64_t wallclockTimeMs) {
+    if(m_index == nullptr || !m_index->Ok()) {
+        return -1;
+    }
+
+    // nearest preceding I-Frame of the requested time
+    return filePositionFromFrame(frameFromClock(wallclockTimeMs), false);
+}
+
+int64_t PacketPlayer::filePositionFromFrame(int frame, bool forward) {
+    // nearest I-Frame in search direction (the search starts at the next frame)
+    uint16_t fileNumber = 0;
+    off_t fileOffset = 0;
+
+    if(m_index->GetNextIFrame(forward ? frame - 1 : frame + 1, forward, &fileNumber, &fileOffset) < 0) {
+        return -1;
+    }
+
+    // segment files are numbered from 1
+    int segment = fileNumber - 1;
+
+    if(segment < 0 || segment >= (int)m_segments.size()) {
+        return -1;
+    }
+
+    return m_segments[segment].start + fileOffset;
+}
+
+int64_t PacketPlayer::timestampFromPosition(int64_t position, bool dts) {
+    int bytesRead = getBlock(m_buffer, position, maxPacketCount * TS_SIZE, false);
+
+    // find the first video PES header carrying a timestamp
+    for(int i = 0; i + TS_SIZE <= bytesRead; i += TS_SIZE) {
+        uint8_t* p = m_buffer + i;
+
+        if(p[0] != TS_SYNC_BYTE || !TsHasPayload(p) || !TsPayloadStart(p)) {
+            continue;
+        }
+
+        int offset = TsPayloadOffset(p);
+
+        if(offset + 19 > TS_SIZE) {
+            continue;
+        }
+
+        uint8_t* pes = p + offset;
+
+        if(pes[0] != 0 || pes[1] != 0 || pes[2] != 1 || (pes[3] & 0xF0) != 0xE0) {
+            continue;
+        }
+
+        if(dts && PesHasDts(pes)) {
+            return PesGetDts(pes);
+        }
+
+        if(PesHasPts(pes)) {
+            return PesGetPts(pes);
+        }
+    }
+
+    return DVD_NOPTS_VALUE;
+}
+
 int64_t PacketPlayer::seek(int64_t wallclockTimeMs) {
-    // adujst position to TS packet borders
-    m_position = filePositionFromClock(wallclockTimeMs);
+    // lookup I-Frame position in the index
+    int64_t position = filePositionFromIndex(wallclockTimeMs);
+
+    // fallback - interpolate by file position
+    if(position < 0) {
+        position = filePositionFromClock(wallclockTimeMs);
+    }
 
     // invalid position ?
-    if(m_position >= m_totalLength) {
+    if(position >= m_totalLength) {
         return 0;
     }
 
-    if(m_position < 0) {
-        m_position = 0;
+    if(position < 0) {
+        position = 0;
     }
 
+    m_position = position;
+    m_trickSpeed = 0;
     isyslog("seek: %lu / %lu (%lu)", m_position, m_totalLength, wallclockTimeMs / 1000);
 
     // reset parser
     reset();
-    return 0;
+
+    int64_t pts = timestampFromPosition(m_position);
+    return (pts == DVD_NOPTS_VALUE) ? 0 : pts;
+}
+
+bool PacketPlayer::setTrickPlay(int speed) {
+    // normal playback
+    if(speed >= -1 && speed <= 1) {
+        speed = 0;
+    }
+
+    speed = std::max(-64, std::min(64, speed));
+
+    if(speed == m_trickSpeed) {
+        return true;
+    }
+
+    if(speed != 0 && (m_index == nullptr || !m_index->Ok())) {
+        esyslog("PacketPlayer: trick play needs an index file");
+        return false;
+    }
+
+    isyslog("trick play speed: %i", speed);
+
+    // continue from the current picture
+    if(m_trickSpeed == 0) {
+        m_trickFrame = frameFromClock(m_currentTime);
+        m_trickTarget = m_trickFrame;
+    }
+
+    m_trickSpeed = speed;
+
+    // drop pending packets (normal playback continues at the last I-Frame)
+    delete m_streamPacket;
+    m_streamPacket = nullptr;
+    clearQueue();
+
+    if(speed == 0) {
+        reset();
+    }
+
+    return true;
 }
 
+bool PacketPlayer::setSkipMarks(bool skip) {
+    m_cuts.clear();
+
+    if(!skip) {
+        return true;
+    }
+
+    if(m_index == nullptr || !m_index->Ok()) {
+        esyslog("PacketPlayer: skipping marks needs an index file");
+        return false;
+    }
+
+    cMarks marks;
+
+    if(!marks.Load(m_fileName.c_str(), m_framesPerSecond, m_isPesRecording)) {
+        isyslog("PacketPlayer: no marks found for: '%s'", m_fileName.c_str());
+        return false;
+    }
+
+    // everything outside of the begin / end marks is cut out
+    cMark* begin = nullptr;
+    cMark* end = nullptr;
+    int64_t cutStart = 0;
+    int scenes = 0;
+
+    while((begin = marks.GetNextBegin(end)) != nullptr) {
+        scenes++;
+
+        // scenes start at the I-Frame of the begin mark
+        int64_t sceneStart = filePositionFromFrame(begin->Position(), false);
+
+        if(sceneStart > cutStart) {
+            m_cuts.push_back({cutStart, sceneStart});
+        }
+
+        // no end mark - the scene lasts until the end of the recording
+        if((end = marks.GetNextEnd(begin)) == nullptr) {
+            cutStart = -1;
+            break;
+        }
+
+        // scenes end before the next I-Frame following the end mark
+        if((cutStart = filePositionFromFrame(end->Position(), true)) < 0) {
+            break;
+        }
+    }
+
+    // no scenes found
+    if(scenes == 0) {
+        isyslog("PacketPlayer: no begin marks found for: '%s'", m_fileName.c_str());
+        return false;
+    }
+
+    if(cutStart >= 0) {
+        m_cuts.push_back({cutStart, std::numeric_limits<int64_t>::max()});
+    }
+
+    isyslog("PacketPlayer: skipping %lu marked segments", m_cuts.size());
+    return true;
+}
+
+bool PacketPlayer::isStillRecording() {
+    return (m_index != nullptr && m_index->IsStillRecording());
+}
+
+MsgPacket* PacketPlayer::getPreviews(int count) {
+    if(m_index == nullptr || !m_index->Ok() || count <= 0) {
+        return nullptr;
+    }
+
+    struct Preview {
+        int64_t time;
+        std::vector<uint8_t> data;
+    };
+
+    std::vector<Preview> previews;
+    int last = m_index->Last();
+    double fps = m_framesPerSecond;
+
+    m_previewMode = true;
+
+    // I-Frames at evenly spaced positions
+    for(int i = 0; i < count; i++) {
+        int frame = (int)(((int64_t)last * (2 * i + 1)) / (2 * count));
+
+        m_preview.clear();
+        frame = demuxIFrame(frame, false);
+
+        if(frame < 0 || m_preview.empty()) {
+            continue;
+        }
+
+        previews.push_back({(int64_t)(frame * 1000 / fps), std::move(m_preview)});
+    }
+
+    m_previewMode = false;
+    m_preview.clear();
+
+    // video decoder data
+    TsDemuxer* video = nullptr;
+
+    for(auto i : getDemuxers()) {
+        if(i->getContent() == StreamInfo::Content::VIDEO) {
+            video = i;
+            break;
+        }
+    }
+
+    if(video == nullptr || previews.empty()) {
+        return nullptr;
+    }
+
+    MsgPacket* p = new MsgPacket();
+    p->put_U32(ROBOTV_RET_OK);
+    p->put_String(video->typeName());
+    p->put_U32(video->getWidth());
+    p->put_U32(video->getHeight());
+
+    int length = 0;
+
+    const uint8_t* sps = video->getVideoDecoderSps(length);
+    p->put_U8((uint8_t)length);
+
+    if(sps != NULL) {
+        p->put_Blob((uint8_t*)sps, (uint8_t)length);
+    }
+
+    const uint8_t* pps = video->getVideoDecoderPps(length);
+    p->put_U8((uint8_t)length);
+
+    if(pps != NULL) {
+        p->put_Blob((uint8_t*)pps, (uint8_t)length);
+    }
+
+    const uint8_t* vps = video->getVideoDecoderVps(length);
+    p->put_U8((uint8_t)length);
+
+    if(vps != NULL) {
+        p->put_Blob((uint8_t*)vps, (uint8_t)length);
+    }
+
+    // previews (time offset in ms, I-Frame access unit)
+    p->put_U32((uint32_t)previews.size());
+
+    for(auto& i : previews) {
+        p->put_S64(i.time);
+        p->put_U32((uint32_t)i.data.size());
+        p->put_Blob(i.data.data(), (uint32_t)i.data.size());
+    }
+
+    return p;
+}
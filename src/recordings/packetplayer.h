@@ -34,6 +34,8 @@
 
 #include "vdr/remux.h"
 #include <deque>
+#include <string>
+#include <vector>
 #include <chrono>
 
 class PacketPlayer : public RecPlayer, protected StreamPacketProcessor {
@@ -41,12 +43,41 @@ public:
 
     PacketPlayer(const cRecording* rec);
 
+    /**
+     * Open a recording by its properties.
+     * Doesn't need the recordings lock during playback.
+     */
+    PacketPlayer(const char* fileName, double framesPerSecond, bool isPesRecording);
+
     virtual ~PacketPlayer();
 
     MsgPacket* requestPacket();
 
     int64_t seek(int64_t position);
 
+    /**
+     * Set trick play speed.
+     * Streams I-Frames only at the given speed (-64 .. 64).
+     * A speed of 0 (or +/-1) returns to normal playback.
+     */
+    bool setTrickPlay(int speed);
+
+    /**
+     * Extract preview pictures.
+     * Returns a packet with the video decoder data (SPS / PPS / VPS)
+     * and the I-Frames at "count" evenly spaced positions.
+     */
+    MsgPacket* getPreviews(int count);
+
+    /**
+     * Skip marked segments.
+     * Playback jumps across the parts outside of the
+     * begin / end marks (e.g. commercials) of an edited recording.
+     */
+    bool setSkipMarks(bool skip);
+
+    bool isStillRecording();
+
     const std::chrono::milliseconds& startTime() const {
         return m_startTime;
     }
@@ -63,6 +94,18 @@ protected:
 
     int64_t getCurrentTime(TsDemuxer::StreamPacket *p);
 
+    int64_t getStreamTime(TsDemuxer::StreamPacket *p);
+
+    void onStreamPacket(TsDemuxer::StreamPacket* p);
+
+    bool getTrickPlayFrame();
+
+    int findIFrame(int frame, bool forward, int64_t& position, int& length);
+
+    void demuxFrame(int64_t position, int length);
+
+    int demuxIFrame(int frame, bool forward);
+
     MsgPacket* getNextPacket();
 
     MsgPacket* getPacket();
@@ -71,11 +114,38 @@ protected:
 
     int64_t filePositionFromClock(int64_t wallclockTimeMs);
 
+    int64_t filePositionFromIndex(int64_t wallclockTimeMs);
+
+    int64_t filePositionFromFrame(int frame, bool forward);
+
+    bool skipCut(int& length);
+
+    int frameFromClock(int64_t wallclockTimeMs);
+
+    int64_t timestampFromPosition(int64_t position, bool dts = false);
+
+    void createDemuxers();
+
+    int64_t recordingLength();
+
+    MsgPacket* createStreamChangePacket(DemuxerBundle& bundle);
+
 private:
 
+    struct Cut {
+        int64_t start;
+        int64_t end;
+    };
+
     cIndexFile* m_index;
 
-    const cRecording* m_recording;
+    std::string m_fileName;
+
+    double m_framesPerSecond;
+
+    bool m_isPesRecording;
+
+    uint32_t m_uid;
 
     int64_t m_position;
 
@@ -87,6 +157,32 @@ private:
 
     std::chrono::milliseconds m_endTime;
 
+    int64_t m_lengthMs = 0;
+
+    int64_t m_firstDts = DVD_NOPTS_VALUE;
+
+    int64_t m_lastUpdateDts = DVD_NOPTS_VALUE;
+
+    // wallclock time of the last packet
+    int64_t m_currentTime = 0;
+
+    int64_t m_lastPts = 0;
+
+    int m_trickSpeed = 0;
+
+    // last I-Frame sent in trick play mode
+    int m_trickFrame = 0;
+
+    // current frame in trick play mode (advances at the trick play speed)
+    double m_trickTarget = 0;
+
+    bool m_previewMode = false;
+
+    std::vector<uint8_t> m_preview;
+
+    // cut out segments (file positions, sorted)
+    std::vector<Cut> m_cuts;
+
     static const int maxPacketCount = 200;
 
     uint8_t* m_buffer;
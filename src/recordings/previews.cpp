@@ -0,0 +1,99 @@
+/*
+ *      vdr-plugin-robotv - roboTV server plugin for VDR
+ *
+ *      Copyright (C) 2016 Alexander Pipelka
+ *
+ *      https://github.com/pipelka/vdr-plugin-robotv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+
+#include "net/msgpacket.h"
+#include "packetplayer.h"
+#include "previews.h"
+
+MsgPacket* Previews::get(const char* recordingFileName, double framesPerSecond, bool isPesRecording, uint32_t uid, int count) {
+    cString fileName = cString::sprintf("%s/robotv-previews-%08x-%i.bin", recordingFileName, uid, count);
+
+    // cached previews
+    MsgPacket* p = load(fileName);
+
+    if(p != nullptr) {
+        return p;
+    }
+
+    // extract previews from the recording
+    PacketPlayer player(recordingFileName, framesPerSecond, isPesRecording);
+    p = player.getPreviews(count);
+
+    if(p == nullptr) {
+        return nullptr;
+    }
+
+    // the recording may still change
+    if(!player.isStillRecording()) {
+        store(fileName, p);
+    }
+
+    return p;
+}
+
+MsgPacket* Previews::load(const char* fileName) {
+    int fd = open(fileName, O_RDONLY);
+
+    if(fd == -1) {
+        return nullptr;
+    }
+
+    MsgPacket* p = MsgPacket::read(fd);
+    close(fd);
+
+    if(p == nullptr) {
+        esyslog("unable to read previews from '%s'", fileName);
+        return nullptr;
+    }
+
+    dsyslog("previews loaded from '%s'", fileName);
+    return p;
+}
+
+void Previews::store(const char* fileName, MsgPacket* p) {
+    // write the file in one go
+    cString tempFileName = cString::sprintf("%s.tmp", fileName);
+    int fd = open(tempFileName, O_WRONLY | O_CREAT | O_TRUNC, DEFFILEMODE);
+
+    if(fd == -1) {
+        esyslog("unable to create '%s'", (const char*)tempFileName);
+        return;
+    }
+
+    // store a copy (writing freezes the packet header)
+    MsgPacket copy;
+    copy.put_Blob(p->getPayload(), p->getPayloadLength());
+
+    bool success = copy.write(fd);
+    close(fd);
+
+    if(!success || rename(tempFileName, fileName) != 0) {
+        esyslog("unable to write previews to '%s'", fileName);
+        unlink(tempFileName);
+    }
+}
@@ -0,0 +1,55 @@
+/*
+ *      vdr-plugin-robotv - roboTV server plugin for VDR
+ *
+ *      Copyright (C) 2016 Alexander Pipelka
+ *
+ *      https://github.com/pipelka/vdr-plugin-robotv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#ifndef ROBOTV_PREVIEWS_H
+#define ROBOTV_PREVIEWS_H
+
+#include <stdint.h>
+
+class MsgPacket;
+
+/**
+ * Preview pictures of recordings.
+ * The extracted I-Frames of a recording are cached in a file in the
+ * recording directory, so following requests don't touch the stream.
+ */
+class Previews {
+public:
+
+    /**
+     * Get the previews of a recording.
+     * Takes the recording properties (not the cRecording), so the
+     * extraction runs without holding the recordings lock.
+     */
+    static MsgPacket* get(const char* recordingFileName, double framesPerSecond, bool isPesRecording, uint32_t uid, int count);
+
+private:
+
+    static MsgPacket* load(const char* fileName);
+
+    static void store(const char* fileName, MsgPacket* p);
+
+};
+
+#endif // ROBOTV_PREVIEWS_H
@@ -0,0 +1,155 @@
+/*
+ *      vdr-plugin-robotv - roboTV server plugin for VDR
+ *
+ *      Copyright (C) 2016 Alexander Pipelka
+ *
+ *      https://github.com/pipelka/vdr-plugin-robotv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <fcntl.h>
+#include <algorithm>
+#include <unistd.h>
+#include <vdr/tools.h>
+
+#include "readahead.h"
+
+#ifndef O_NOATIME
+#define O_NOATIME 0
+#endif
+
+// size of a single prefetch operation
+#define PREFETCH_CHUNK_SIZE (1024 * 1024)
+
+int64_t ReadAhead::m_windowSize = 8 * 1024 * 1024;
+
+ReadAhead::ReadAhead() : m_thread(nullptr), m_running(false), m_file(-1) {
+}
+
+ReadAhead::~ReadAhead() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+        m_requests.clear();
+        m_cond.notify_one();
+    }
+
+    if(m_thread != nullptr) {
+        m_thread->join();
+    }
+
+    delete m_thread;
+    closeFile();
+}
+
+void ReadAhead::setWindowSize(int64_t size) {
+    m_windowSize = size;
+    isyslog("recording read-ahead: %li bytes", m_windowSize);
+}
+
+void ReadAhead::prefetch(const std::string& fileName, int64_t offset, int64_t length) {
+    if(length <= 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // start thread on demand
+    if(m_thread == nullptr) {
+        m_running = true;
+        m_thread = new std::thread(&ReadAhead::action, this);
+    }
+
+    m_requests.push_back({fileName, offset, length});
+    m_cond.notify_one();
+}
+
+void ReadAhead::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_requests.clear();
+}
+
+bool ReadAhead::openFile(const std::string& fileName) {
+    if(m_file != -1 && fileName == m_fileName) {
+        return true;
+    }
+
+    closeFile();
+
+    m_file = open(fileName.c_str(), O_RDONLY | O_NOATIME);
+
+    // fallback if FS doesn't support NOATIME
+    if(m_file == -1) {
+        m_file = open(fileName.c_str(), O_RDONLY);
+    }
+
+    if(m_file == -1) {
+        return false;
+    }
+
+    m_fileName = fileName;
+    return true;
+}
+
+void ReadAhead::closeFile() {
+    if(m_file == -1) {
+        return;
+    }
+
+    close(m_file);
+    m_file = -1;
+}
+
+void ReadAhead::action() {
+    while(m_running) {
+        Request request;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            m_cond.wait(lock, [&]() {
+                return !m_running || !m_requests.empty();
+            });
+
+            if(!m_running) {
+                break;
+            }
+
+            // process large requests in chunks, so a seek can drop the remainder
+            Request& r = m_requests.front();
+            request = r;
+            request.length = std::min<int64_t>(r.length, PREFETCH_CHUNK_SIZE);
+
+            r.offset += request.length;
+            r.length -= request.length;
+
+            if(r.length <= 0) {
+                m_requests.pop_front();
+            }
+        }
+
+        if(!openFile(request.fileName)) {
+            esyslog("ReadAhead: unable to open %s", request.fileName.c_str());
+            continue;
+        }
+
+#ifndef __FreeBSD__
+        posix_fadvise(m_file, request.offset, request.length, POSIX_FADV_WILLNEED);
+#endif
+    }
+}
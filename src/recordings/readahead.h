@@ -0,0 +1,89 @@
+/*
+ *      vdr-plugin-robotv - roboTV server plugin for VDR
+ *
+ *      Copyright (C) 2016 Alexander Pipelka
+ *
+ *      https://github.com/pipelka/vdr-plugin-robotv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#ifndef ROBOTV_READAHEAD_H
+#define ROBOTV_READAHEAD_H
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * Prefetches recording data into the page cache.
+ * Requested file ranges are passed to the kernel (POSIX_FADV_WILLNEED)
+ * by a background thread, so disk latency doesn't stall the reader.
+ */
+class ReadAhead {
+public:
+
+    ReadAhead();
+
+    virtual ~ReadAhead();
+
+    void prefetch(const std::string& fileName, int64_t offset, int64_t length);
+
+    void clear();
+
+    static void setWindowSize(int64_t size);
+
+    static int64_t getWindowSize() {
+        return m_windowSize;
+    }
+
+private:
+
+    struct Request {
+        std::string fileName;
+        int64_t offset;
+        int64_t length;
+    };
+
+    void action();
+
+    bool openFile(const std::string& fileName);
+
+    void closeFile();
+
+    std::deque<Request> m_requests;
+
+    std::mutex m_mutex;
+
+    std::condition_variable m_cond;
+
+    std::thread* m_thread;
+
+    std::atomic<bool> m_running;
+
+    int m_file;
+
+    std::string m_fileName;
+
+    static int64_t m_windowSize;
+};
+
+#endif // ROBOTV_READAHEAD_H
@@ -0,0 +1,90 @@
+/*
+ *      vdr-plugin-robotv - roboTV server plugin for VDR
+ *
+ *      Copyright (C) 2016 Alexander Pipelka
+ *
+ *      https://github.com/pipelka/vdr-plugin-robotv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "readerregistry.h"
+
+// readers further behind won't find the data in the page cache anyway
+#define MAX_READER_DISTANCE (256 * 1024 * 1024)
+
+ReaderRegistry& ReaderRegistry::instance() {
+    static ReaderRegistry registry;
+    return registry;
+}
+
+void ReaderRegistry::add(const std::string& recording, const void* reader) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_readers[recording][reader] = 0;
+}
+
+void ReaderRegistry::remove(const std::string& recording, const void* reader) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto i = m_readers.find(recording);
+
+    if(i == m_readers.end()) {
+        return;
+    }
+
+    i->second.erase(reader);
+
+    if(i->second.empty()) {
+        m_readers.erase(i);
+    }
+}
+
+void ReaderRegistry::setPosition(const std::string& recording, const void* reader, int64_t position) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto i = m_readers.find(recording);
+
+    if(i == m_readers.end()) {
+        return;
+    }
+
+    auto r = i->second.find(reader);
+
+    if(r != i->second.end()) {
+        r->second = position;
+    }
+}
+
+bool ReaderRegistry::hasReaderBehind(const std::string& recording, const void* reader, int64_t position) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto i = m_readers.find(recording);
+
+    // single reader
+    if(i == m_readers.end() || i->second.size() < 2) {
+        return false;
+    }
+
+    for(auto& r : i->second) {
+        if(r.first == reader) {
+            continue;
+        }
+
+        if(r.second < position && position - r.second <= MAX_READER_DISTANCE) {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,69 @@
+/*
+ *      vdr-plugin-robotv - roboTV server plugin for VDR
+ *
+ *      Copyright (C) 2016 Alexander Pipelka
+ *
+ *      https://github.com/pipelka/vdr-plugin-robotv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#ifndef ROBOTV_READERREGISTRY_H
+#define ROBOTV_READERREGISTRY_H
+
+#include <stdint.h>
+#include <map>
+#include <mutex>
+#include <string>
+
+/**
+ * Registry of the active readers of recordings.
+ * Keeps track of the read positions of all players of a recording,
+ * so a player doesn't evict data from the page cache that another
+ * player (behind it) is about to read.
+ */
+class ReaderRegistry {
+public:
+
+    static ReaderRegistry& instance();
+
+    void add(const std::string& recording, const void* reader);
+
+    void remove(const std::string& recording, const void* reader);
+
+    void setPosition(const std::string& recording, const void* reader, int64_t position);
+
+    /**
+     * Check for other readers behind a position.
+     * @return true if another reader of the recording will read the data before "position"
+     */
+    bool hasReaderBehind(const std::string& recording, const void* reader, int64_t position);
+
+protected:
+
+    ReaderRegistry() = default;
+
+private:
+
+    std::mutex m_mutex;
+
+    // read positions of the readers of a recording
+    std::map<std::string, std::map<const void*, int64_t>> m_readers;
+
+};
+
+#endif // ROBOTV_READERREGISTRY_H
@@ -29,9 +29,81 @@
 #include "recordingscache.h"
 #include "tools/hash.h"
 
-RecordingsCache::RecordingsCache() {
+RecordingsCache::RecordingsCache(bool preload) : m_preload(preload) {
     // create db schema
     createDb();
+
+    if(m_preload) {
+        load();
+    }
+}
+
+void RecordingsCache::load() {
+    load(query("SELECT recid, filename, position, playcount, posterurl, backgroundurl, externalid FROM recordings;"));
+    isyslog("loaded %lu recordings into cache", m_metadata.size());
+}
+
+void RecordingsCache::load(sqlite3_stmt* s) {
+    if(s == NULL) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_metadataMutex);
+
+    while(sqlite3_step(s) == SQLITE_ROW) {
+        uint32_t uid = (uint32_t)sqlite3_column_int(s, 0);
+
+        // keep (maybe modified) entries
+        if(m_metadata.find(uid) != m_metadata.end()) {
+            continue;
+        }
+
+        Metadata& m = m_metadata[uid];
+
+        m.fileName = (const char*)sqlite3_column_text(s, 1);
+        m.position = sqlite3_column_int64(s, 2);
+        m.playCount = sqlite3_column_int(s, 3);
+        m.posterUrl = (const char*)sqlite3_column_text(s, 4);
+        m.backgroundUrl = (const char*)sqlite3_column_text(s, 5);
+        m.externalId = (uint32_t)sqlite3_column_int(s, 6);
+    }
+
+    sqlite3_finalize(s);
+}
+
+void RecordingsCache::flush() {
+    std::lock_guard<std::mutex> lock(m_metadataMutex);
+    bool pending = false;
+
+    for(auto& i : m_metadata) {
+        Metadata& m = i.second;
+
+        if(!m.dirty) {
+            continue;
+        }
+
+        if(!pending) {
+            begin();
+            pending = true;
+        }
+
+        exec(
+            "INSERT OR REPLACE INTO recordings(recid, filename, position, playcount, posterurl, backgroundurl, externalid) "
+            "VALUES(%u, %Q, %llu, %i, %Q, %Q, %u);",
+            i.first,
+            (const char*)m.fileName,
+            m.position,
+            m.playCount,
+            (const char*)m.posterUrl,
+            (const char*)m.backgroundUrl,
+            m.externalId);
+
+        m.dirty = false;
+    }
+
+    if(pending) {
+        commit();
+    }
 }
 
 void RecordingsCache::update(const cRecordings* recordings) {
@@ -44,7 +116,7 @@ RecordingsCache::~RecordingsCache() {
 }
 
 RecordingsCache& RecordingsCache::instance() {
-    static RecordingsCache singleton;
+    static RecordingsCache singleton(true);
     return singleton;
 }
 
@@ -59,6 +131,19 @@ uint32_t RecordingsCache::update(uint32_t uid, const cRecording* recording) {
             (const char*)filename,
             uid);
 
+    if(m_preload) {
+        std::lock_guard<std::mutex> lock(m_metadataMutex);
+        auto i = m_metadata.find(uid);
+
+        if(i != m_metadata.end()) {
+            Metadata m = i->second;
+            m.fileName = filename;
+
+            m_metadata.erase(i);
+            m_metadata[newUid] = m;
+        }
+    }
+
     return newUid;
 }
 
@@ -66,6 +151,17 @@ uint32_t RecordingsCache::add(const cRecording* recording) {
     cString filename = recording->FileName();
     uint32_t uid = roboTV::Hash::createStringHash((const char*)filename);
 
+    // already known
+    if(m_preload) {
+        std::lock_guard<std::mutex> lock(m_metadataMutex);
+
+        if(m_metadata.find(uid) != m_metadata.end()) {
+            return uid;
+        }
+
+        m_metadata[uid].fileName = filename;
+    }
+
     // try to update existing record
     exec(
         "INSERT OR IGNORE INTO recordings(recid, filename) VALUES(%u, %Q);",
@@ -94,21 +190,22 @@ const cRecording* RecordingsCache::lookup(const cRecordings* recordings, uint32_
 cRecording* RecordingsCache::lookup(cRecordings* recordings, uint32_t uid) {
     dsyslog("%s - lookup uid: %08x", __FUNCTION__, uid);
 
-    sqlite3_stmt* s = query("SELECT filename FROM recordings WHERE recid=%u;", uid);
+    cString filename;
 
-    if(s == NULL) {
-        dsyslog("%s - not found !", __FUNCTION__);
-        return NULL;
-    }
+    // recordings added by the garbage collector may be missing
+    for(int retry = 0; retry < 2 && isempty(filename); retry++) {
+        if(retry > 0) {
+            load(query("SELECT recid, filename, position, playcount, posterurl, backgroundurl, externalid FROM recordings WHERE recid=%u;", uid));
+        }
 
-    cString filename;
+        std::lock_guard<std::mutex> lock(m_metadataMutex);
+        auto i = m_metadata.find(uid);
 
-    if(sqlite3_step(s) == SQLITE_ROW) {
-        filename = (const char*)sqlite3_column_text(s, 0);
+        if(i != m_metadata.end()) {
+            filename = i->second.fileName;
+        }
     }
 
-    sqlite3_finalize(s);
-
     if(isempty(filename)) {
         dsyslog("%s - empty filename for uid: %08x !", __FUNCTION__, uid);
         return NULL;
@@ -123,112 +220,113 @@ cRecording* RecordingsCache::lookup(cRecordings* recordings, uint32_t uid) {
 }
 
 void RecordingsCache::setPlayCount(uint32_t uid, int count) {
-    exec(
-        "UPDATE recordings SET playcount=%i WHERE recid=%u;",
-        count,
-        uid);
+    std::lock_guard<std::mutex> lock(m_metadataMutex);
+    auto i = m_metadata.find(uid);
+
+    if(i != m_metadata.end()) {
+        i->second.playCount = count;
+        i->second.dirty = true;
+    }
 }
 
 void RecordingsCache::setLastPlayedPosition(uint32_t uid, uint64_t position) {
-    exec(
-        "UPDATE recordings SET position=%llu WHERE recid=%u;",
-        position,
-        uid);
+    std::lock_guard<std::mutex> lock(m_metadataMutex);
+    auto i = m_metadata.find(uid);
+
+    if(i != m_metadata.end()) {
+        i->second.position = position;
+        i->second.dirty = true;
+    }
 }
 
 void RecordingsCache::setPosterUrl(uint32_t uid, const char* url) {
-    exec(
-        "UPDATE recordings SET posterurl=%Q WHERE recid=%u;",
-        url,
-        uid);
+    std::lock_guard<std::mutex> lock(m_metadataMutex);
+    auto i = m_metadata.find(uid);
+
+    if(i != m_metadata.end()) {
+        i->second.posterUrl = url;
+        i->second.dirty = true;
+    }
 }
 
 void RecordingsCache::setBackgroundUrl(uint32_t uid, const char* url) {
-    exec(
-        "UPDATE recordings SET backgroundurl=%Q WHERE recid=%u;",
-        url,
-        uid);
-}
+    std::lock_guard<std::mutex> lock(m_metadataMutex);
+    auto i = m_metadata.find(uid);
 
-void RecordingsCache::setMovieID(uint32_t uid, uint32_t id) {
-    exec(
-        "UPDATE recordings SET externalid=%u WHERE recid=%u;",
-        id,
-        uid);
+    if(i != m_metadata.end()) {
+        i->second.backgroundUrl = url;
+        i->second.dirty = true;
+    }
 }
 
-int RecordingsCache::getPlayCount(uint32_t uid) {
-    sqlite3_stmt* s = query("SELECT playcount FROM recordings WHERE recid=%u;", uid);
+void RecordingsCache::setMovieID(uint32_t uid, uint32_t id) {
+    std::lock_guard<std::mutex> lock(m_metadataMutex);
+    auto i = m_metadata.find(uid);
 
-    if(s == NULL) {
-        return 0;
+    if(i != m_metadata.end()) {
+        i->second.externalId = id;
+        i->second.dirty = true;
     }
+}
 
-    int count = 0;
-
-    if(sqlite3_step(s) == SQLITE_ROW) {
-        count = sqlite3_column_int(s, 0);
-    }
+int RecordingsCache::getPlayCount(uint32_t uid) {
+    std::lock_guard<std::mutex> lock(m_metadataMutex);
+    auto i = m_metadata.find(uid);
 
-    sqlite3_finalize(s);
-    return count;
+    return (i != m_metadata.end()) ? i->second.playCount : 0;
 }
 
 cString RecordingsCache::getPosterUrl(uint32_t uid) {
-    cString url = "x";
-    sqlite3_stmt* s = query("SELECT posterurl FROM recordings WHERE recid=%u;", uid);
+    std::lock_guard<std::mutex> lock(m_metadataMutex);
+    auto i = m_metadata.find(uid);
 
-    if(s == NULL) {
-        return url;
+    if(i == m_metadata.end() || (const char*)i->second.posterUrl == NULL) {
+        return "x";
     }
 
-    if(sqlite3_step(s) == SQLITE_ROW) {
-        const char* u = (const char*)sqlite3_column_text(s, 0);
-
-        if(u != NULL) {
-            url = u;
-        }
-    }
-
-    sqlite3_finalize(s);
-    return url;
+    return i->second.posterUrl;
 }
 
 cString RecordingsCache::getBackgroundUrl(uint32_t uid) {
-    cString url = "x";
-    sqlite3_stmt* s = query("SELECT backgroundurl FROM recordings WHERE recid=%u;", uid);
+    std::lock_guard<std::mutex> lock(m_metadataMutex);
+    auto i = m_metadata.find(uid);
 
-    if(s == NULL) {
-        return url;
+    if(i == m_metadata.end() || (const char*)i->second.backgroundUrl == NULL) {
+        return "x";
     }
 
-    if(sqlite3_step(s) == SQLITE_ROW) {
-        const char* u = (const char*)sqlite3_column_text(s, 0);
+    return i->second.backgroundUrl;
+}
 
-        if(u != NULL) {
-            url = u;
-        }
-    }
+uint64_t RecordingsCache::getLastPlayedPosition(uint32_t uid) {
+    std::lock_guard<std::mutex> lock(m_metadataMutex);
+    auto i = m_metadata.find(uid);
 
-    sqlite3_finalize(s);
-    return url;
+    return (i != m_metadata.end()) ? i->second.position : 0;
 }
 
-uint64_t RecordingsCache::getLastPlayedPosition(uint32_t uid) {
-    sqlite3_stmt* s = query("SELECT position FROM recordings WHERE recid=%u;", uid);
+bool RecordingsCache::getFirstDts(uint32_t uid, int64_t& dts) {
+    sqlite3_stmt* s = query("SELECT firstdts FROM recordingtimestamps WHERE recid=%u;", uid);
 
     if(s == NULL) {
-        return 0;
+        return false;
     }
 
-    uint64_t position = 0;
+    bool found = (sqlite3_step(s) == SQLITE_ROW);
 
-    if(sqlite3_step(s) == SQLITE_ROW) {
-        position = sqlite3_column_int64(s, 0);
+    if(found) {
+        dts = sqlite3_column_int64(s, 0);
     }
 
     sqlite3_finalize(s);
-    return position;
+    return found;
+}
+
+void RecordingsCache::setFirstDts(uint32_t uid, int64_t dts) {
+    exec(
+        "INSERT OR REPLACE INTO recordingtimestamps(recid, firstdts) VALUES(%u, %lld);",
+        uid,
+        dts);
 }
 
 void RecordingsCache::triggerCleanup() {
@@ -264,6 +362,11 @@ void RecordingsCache::gc(const cRecordings* recordings) {
         if(recordings->GetByName(filename) == nullptr) {
             isyslog("removing outdated recording '%s' from cache", filename);
             storage.exec("DELETE FROM recordings WHERE recid=%u;", recid);
+            storage.exec("DELETE FROM recordingtimestamps WHERE recid=%u;", recid);
+            storage.exec("DELETE FROM recordingcache WHERE channeluid=%u;", recid);
+
+            std::lock_guard<std::mutex> lock(m_metadataMutex);
+            m_metadata.erase(recid);
         }
     }
 
@@ -284,7 +387,11 @@ void RecordingsCache::createDb() {
         ");\n"
         "CREATE INDEX IF NOT EXISTS recordings_externalid on recordings(externalid);\n"
         "CREATE UNIQUE INDEX IF NOT EXISTS recordings_filename on recordings(filename);\n"
-        "CREATE VIRTUAL TABLE IF NOT EXISTS fts_recordings USING fts4(title, subject, description);\n";
+        "CREATE VIRTUAL TABLE IF NOT EXISTS fts_recordings USING fts4(title, subject, description);\n"
+        "CREATE TABLE IF NOT EXISTS recordingtimestamps (\n"
+        "  recid INTEGER PRIMARY KEY,\n"
+        "  firstdts BIGINT\n"
+        ");\n";
 
     if(exec(schema) != SQLITE_OK) {
         esyslog("Unable to create database schema for recordings");
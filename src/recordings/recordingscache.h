@@ -27,6 +27,8 @@
 
 #include <stdint.h>
 #include <map>
+#include <mutex>
+#include <unordered_map>
 #include <functional>
 #include <vdr/thread.h>
 #include <vdr/tools.h>
@@ -36,7 +38,7 @@
 class RecordingsCache : protected roboTV::Storage {
 protected:
 
-    RecordingsCache();
+    RecordingsCache(bool preload = false);
 
     virtual ~RecordingsCache();
 
@@ -72,6 +74,10 @@ public:
 
     void setMovieID(uint32_t uid, uint32_t id);
 
+    bool getFirstDts(uint32_t uid, int64_t& dts);
+
+    void setFirstDts(uint32_t uid, int64_t dts);
+
     void triggerCleanup();
 
     void gc(const cRecordings* recordings);
@@ -80,10 +86,39 @@ public:
 
     void update(const cRecordings* recordings);
 
+    /**
+     * Write modified metadata.
+     * All pending changes are written to the database in a single transaction.
+     */
+    void flush();
+
 protected:
 
     void createDb();
 
+    void load();
+
+    void load(sqlite3_stmt* s);
+
+private:
+
+    // recording metadata (recid -> metadata)
+    struct Metadata {
+        cString fileName;
+        uint64_t position = 0;
+        int playCount = 0;
+        cString posterUrl;
+        cString backgroundUrl;
+        uint32_t externalId = 0;
+        bool dirty = false;
+    };
+
+    std::unordered_map<uint32_t, Metadata> m_metadata;
+
+    std::mutex m_metadataMutex;
+
+    bool m_preload;
+
 };
 
 
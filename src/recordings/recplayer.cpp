@@ -23,59 +23,135 @@
  */
 
 #include <inttypes.h>
+#include <errno.h>
+#include <algorithm>
 #include "recplayer.h"
+#include "readerregistry.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
 
 #ifndef O_NOATIME
 #define O_NOATIME 0
 #endif
 
+#ifndef O_DIRECT
+#define O_DIRECT 0
+#endif
+
+// size and alignment of disk reads
+#define READ_BLOCK_SIZE (2 * 1024 * 1024)
+#define READ_BLOCK_ALIGNMENT 4096
+
+bool RecPlayer::m_directIO = false;
+
 RecPlayer::RecPlayer(const char* filename) : m_recordingFilename(filename) {
     m_file = -1;
     m_fileOpen = -1;
+    m_fileDirect = false;
+    m_directIOFailed = false;
+    m_blockStart = 0;
+    m_blockLength = 0;
+    m_blockFileOffset = 0;
     m_rescanInterval = 0;
+    m_notifyFd = -1;
     m_totalLength = 0;
+    m_readAhead = nullptr;
+    m_readAheadStart = 0;
+    m_readAheadEnd = 0;
+
+    if(posix_memalign((void**)&m_block, READ_BLOCK_ALIGNMENT, READ_BLOCK_SIZE) != 0) {
+        m_block = nullptr;
+    }
+
+#ifdef __linux__
+    // get notified about growing recordings
+    m_notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if(m_notifyFd != -1 && inotify_add_watch(m_notifyFd, filename, IN_MODIFY | IN_CREATE | IN_MOVED_TO) == -1) {
+        close(m_notifyFd);
+        m_notifyFd = -1;
+    }
+#endif
+
+    ReaderRegistry::instance().add(m_recordingFilename, this);
 
     scan();
     m_rescanTime.Set(0);
 }
 
 RecPlayer::~RecPlayer() {
-    cleanup();
+    delete m_readAhead;
+    dropBlock();
     closeFile();
-}
+    ReaderRegistry::instance().remove(m_recordingFilename, this);
+    free(m_block);
 
-void RecPlayer::cleanup() {
-    for(int i = 0; i != m_segments.Size(); i++) {
-        delete m_segments[i];
+    if(m_notifyFd != -1) {
+        close(m_notifyFd);
     }
+}
 
-    m_segments.Clear();
+void RecPlayer::setDirectIO(bool on) {
+    m_directIO = (on && O_DIRECT != 0);
+    isyslog("recording direct I/O: %s", m_directIO ? "enabled" : "disabled");
 }
 
 void RecPlayer::scan() {
     struct stat s;
     m_totalLength = 0;
 
-    cleanup();
+    // only the last segment may still grow
+    if(!m_segments.empty()) {
+        m_totalLength = m_segments.back().start;
+        m_segments.pop_back();
+    }
 
-    for(int i = 0; ; i++) {
+    for(int i = (int)m_segments.size(); ; i++) {
         fileNameFromIndex(i);
 
         if(stat(m_fileName, &s) == -1) {
             break;
         }
 
-        Segment* segment = new Segment();
-        segment->start = m_totalLength;
-        segment->end = segment->start + s.st_size;
+        Segment segment;
+        segment.start = m_totalLength;
+        segment.end = segment.start + s.st_size;
 
-        m_segments.Append(segment);
+        m_segments.push_back(segment);
 
         m_totalLength += s.st_size;
     }
 }
 
+bool RecPlayer::changed() {
+#ifdef __linux__
+    char buffer[4096];
+    bool result = false;
+
+    // drain pending events
+    while(read(m_notifyFd, buffer, sizeof(buffer)) > 0) {
+        result = true;
+    }
+
+    return result;
+#else
+    return false;
+#endif
+}
+
 bool RecPlayer::update() {
+    // rescan on file changes only
+    if(m_notifyFd != -1) {
+        if(!changed()) {
+            return false;
+        }
+
+        scan();
+        return true;
+    }
+
     // do not rescan too often
     if(m_rescanTime.Elapsed() < m_rescanInterval) {
         return false;
@@ -103,8 +179,26 @@ bool RecPlayer::openFile(int index) {
     fileNameFromIndex(index);
     isyslog("openFile called for index %i (%s)", index, m_fileName);
 
+    m_fileDirect = (m_directIO && !m_directIOFailed);
+
+    // try direct I/O first (if enabled)
+    if(m_fileDirect) {
+        m_file = open(m_fileName, O_RDONLY | O_NOATIME | O_DIRECT);
+
+        if(m_file == -1) {
+            m_file = open(m_fileName, O_RDONLY | O_DIRECT);
+        }
+
+        // fallback if FS doesn't support O_DIRECT
+        if(m_file == -1) {
+            m_fileDirect = false;
+        }
+    }
+
     // first try to open with NOATIME flag
-    m_file = open(m_fileName, O_RDONLY | O_NOATIME);
+    if(m_file == -1) {
+        m_file = open(m_fileName, O_RDONLY | O_NOATIME);
+    }
 
     // fallback if FS doesn't support NOATIME
     if(m_file == -1) {
@@ -138,64 +232,169 @@ int64_t RecPlayer::getLengthBytes() {
     return m_totalLength;
 }
 
-int RecPlayer::getBlock(unsigned char* buffer, int64_t position, int64_t amount) {
-    if(position >= m_totalLength) {
-        esyslog("RecPlayer: position %lu past size of %lu bytes", position, m_totalLength);
-        return 0;
+int RecPlayer::segmentFromPosition(int64_t position) {
+    // first segment ending behind "position"
+    auto i = std::upper_bound(m_segments.begin(), m_segments.end(), position, [](int64_t p, const Segment& s) {
+        return p < s.end;
+    });
+
+    if(i == m_segments.end() || position < i->start) {
+        return -1;
     }
 
-    if((position + amount) > m_totalLength) {
-        amount = m_totalLength - position;
+    return (int)(i - m_segments.begin());
+}
+
+void RecPlayer::readAhead(int64_t position) {
+    int64_t windowSize = ReadAhead::getWindowSize();
+
+    // the page cache isn't used with direct I/O
+    if(windowSize <= 0 || m_directIO) {
+        return;
     }
 
-    // work out what block "position" is in
-    int segmentNumber = -1;
+    if(m_readAhead == nullptr) {
+        m_readAhead = new ReadAhead();
+    }
+
+    // position outside of the read-ahead window (seek) - drop pending requests
+    if(position < m_readAheadStart || position > m_readAheadEnd) {
+        m_readAhead->clear();
+        m_readAheadEnd = position;
+    }
+
+    m_readAheadStart = position;
 
-    for(int i = 0; i < m_segments.Size(); i++) {
-        if((position >= m_segments[i]->start) && (position < m_segments[i]->end)) {
-            segmentNumber = i;
+    // refill if less than half of the window is left
+    if(m_readAheadEnd - position > windowSize / 2) {
+        return;
+    }
+
+    int64_t end = std::min(position + windowSize, m_totalLength);
+
+    while(m_readAheadEnd < end) {
+        int segmentNumber = segmentFromPosition(m_readAheadEnd);
+
+        if(segmentNumber == -1) {
             break;
         }
+
+        const Segment& segment = m_segments[segmentNumber];
+        int64_t length = std::min(end, segment.end) - m_readAheadEnd;
+
+        m_readAhead->prefetch(fileNameFromIndex(segmentNumber), m_readAheadEnd - segment.start, length);
+        m_readAheadEnd += length;
+    }
+}
+
+void RecPlayer::dropBlock() {
+    // keep the data for other readers of the recording
+    bool shared = ReaderRegistry::instance().hasReaderBehind(m_recordingFilename, this, m_blockStart + m_blockLength);
+
+    if(m_blockLength > 0 && m_file != -1 && !m_fileDirect && !shared) {
+#ifndef __FreeBSD__
+        // Tell linux not to bother keeping the data in the FS cache
+        posix_fadvise(m_file, m_blockFileOffset, m_blockLength, POSIX_FADV_DONTNEED);
+#endif
     }
 
+    m_blockLength = 0;
+}
+
+bool RecPlayer::readBlock(int64_t position, int64_t length) {
+    if(m_block == nullptr) {
+        return false;
+    }
+
+    // work out what block "position" is in
+    int segmentNumber = segmentFromPosition(position);
+
     // segment not found / invalid position
     if(segmentNumber == -1) {
         esyslog("RecPlayer: segment number for position %lu not found !", position);
-        return 0;
+        return false;
     }
 
+    // release the previous block (before the file may change)
+    dropBlock();
+
     // open file (if not already open)
     if(!openFile(segmentNumber)) {
         esyslog("RecPlayer: unable to open segment #%i", segmentNumber);
-        return 0;
+        return false;
     }
 
-    // work out position in current file
-    int64_t filePosition = position - m_segments[segmentNumber]->start;
+    // aligned position in current file
+    const Segment& segment = m_segments[segmentNumber];
+    int64_t filePosition = (position - segment.start) & ~((int64_t)READ_BLOCK_ALIGNMENT - 1);
 
-    // seek to position
-    if(lseek(m_file, filePosition, SEEK_SET) == -1) {
-        esyslog("RecPlayer: unable to seek to position: %lu", filePosition);
-        return 0;
+    // whole aligned pages of the requested range
+    int64_t end = (position - segment.start + length + READ_BLOCK_ALIGNMENT - 1) & ~((int64_t)READ_BLOCK_ALIGNMENT - 1);
+    size_t size = (size_t)std::min<int64_t>(end - filePosition, READ_BLOCK_SIZE);
+
+    ssize_t bytesRead = pread(m_file, m_block, size, filePosition);
+
+    // direct I/O not supported - reopen file without O_DIRECT
+    if(bytesRead == -1 && errno == EINVAL && m_fileDirect) {
+        esyslog("RecPlayer: direct I/O failed - using buffered I/O");
+        m_directIOFailed = true;
+        closeFile();
+
+        if(!openFile(segmentNumber)) {
+            return false;
+        }
+
+        bytesRead = pread(m_file, m_block, size, filePosition);
     }
 
-    // try to read the block
-    ssize_t bytes_read = read(m_file, buffer, (size_t)amount);
+    if(bytesRead <= 0) {
+        esyslog("RecPlayer: read returned %li", bytesRead);
+        return false;
+    }
 
-    if(bytes_read <= 0) {
-        esyslog("RecPlayer: read returned %lu", bytes_read);
+    m_blockFileOffset = filePosition;
+    m_blockStart = segment.start + filePosition;
+
+    // blocks never span segments
+    m_blockLength = std::min((int64_t)bytesRead, segment.end - m_blockStart);
+
+    return (position < m_blockStart + m_blockLength);
+}
+
+int RecPlayer::getBlock(unsigned char* buffer, int64_t position, int64_t amount, bool sequential) {
+    if(position >= m_totalLength) {
+        esyslog("RecPlayer: position %lu past size of %lu bytes", position, m_totalLength);
         return 0;
     }
 
-#ifndef __FreeBSD__
-    // Tell linux not to bother keeping the data in the FS cache
-    posix_fadvise(m_file, filePosition, bytes_read, POSIX_FADV_DONTNEED);
-#endif
+    if((position + amount) > m_totalLength) {
+        amount = m_totalLength - position;
+    }
+
+    // prefetch data ahead of the current position
+    if(sequential) {
+        readAhead(position);
+    }
+
+    int64_t bytesRead = 0;
+
+    while(bytesRead < amount) {
+        // read the block containing "position"
+        if(position < m_blockStart || position >= m_blockStart + m_blockLength) {
+            if(!readBlock(position, sequential ? READ_BLOCK_SIZE : amount - bytesRead)) {
+                break;
+            }
+        }
+
+        int64_t offset = position - m_blockStart;
+        int64_t length = std::min(amount - bytesRead, m_blockLength - offset);
+
+        memcpy(&buffer[bytesRead], &m_block[offset], (size_t)length);
 
-    // divide and conquer
-    if(bytes_read < amount) {
-        bytes_read += getBlock(&buffer[bytes_read], position + bytes_read, amount - bytes_read);
+        bytesRead += length;
+        position += length;
     }
 
-    return (int)bytes_read;
+    ReaderRegistry::instance().setPosition(m_recordingFilename, this, position);
+    return (int)bytesRead;
 }
@@ -27,9 +27,12 @@
 
 #include <stdio.h>
 #include <string>
+#include <vector>
 #include <vdr/tools.h>
 #include <vdr/recording.h>
 
+#include "readahead.h"
+
 class Segment {
 public:
     int64_t start;
@@ -45,39 +48,78 @@ public:
 
     int64_t getLengthBytes();
 
-    int getBlock(unsigned char* buffer, int64_t position, int64_t amount);
+    // sequential = false: random access (no read-ahead, reads only "amount" bytes)
+    int getBlock(unsigned char* buffer, int64_t position, int64_t amount, bool sequential = true);
 
     bool openFile(int index);
 
     void closeFile();
 
+    static void setDirectIO(bool on);
+
 protected:
 
     bool update();
 
     int64_t m_totalLength;
 
-    cVector<Segment*> m_segments;
+    // segment files, sorted by position
+    std::vector<Segment> m_segments;
 
 private:
 
     void scan();
 
-    void cleanup();
+    bool changed();
 
     char* fileNameFromIndex(int index);
 
+    int segmentFromPosition(int64_t position);
+
+    void readAhead(int64_t position);
+
+    bool readBlock(int64_t position, int64_t length);
+
+    void dropBlock();
+
     char m_fileName[512];
 
     int m_file;
 
     int m_fileOpen;
 
+    // file opened with O_DIRECT
+    bool m_fileDirect;
+
+    bool m_directIOFailed;
+
+    // aligned block buffer
+    uint8_t* m_block;
+
+    int64_t m_blockStart;
+
+    int64_t m_blockLength;
+
+    int64_t m_blockFileOffset;
+
     std::string m_recordingFilename;
 
     cTimeMs m_rescanTime;
 
     uint32_t m_rescanInterval;
+
+    // inotify watch on the recording directory
+    int m_notifyFd;
+
+    // started with the first sequential read
+    ReadAhead* m_readAhead;
+
+    // range of the last read-ahead request
+    int64_t m_readAheadStart;
+
+    int64_t m_readAheadEnd;
+
+    static bool m_directIO;
 };
 
 #endif // ROBOTV_RECPLAYER_H
@@ -97,7 +97,6 @@ bool StreamPacketProcessor::putTsPacket(uint8_t *data, int64_t position) {
                 isyslog("found new PAT/PMT version (%i/%i)", patVersion, pmtVersion);
 
                 cleanupQueue();
-                m_demuxers.clear();
 
                 m_pmtVersion = pmtVersion;
                 m_patVersion = patVersion;
@@ -134,6 +133,8 @@ void StreamPacketProcessor::reset() {
     m_patVersion = -1;
     m_pmtVersion = -1;
 
+    m_announcedPids.clear();
+
     cleanupQueue();
 }
 
@@ -143,6 +144,18 @@ void StreamPacketProcessor::onStreamPacket(TsDemuxer::StreamPacket *p) {
         return;
     }
 
+    // stream not announced with the last stream change
+    bool announced = (m_announcedPids.count(p->pid) != 0);
+
+    if(!announced) {
+        TsDemuxer* demuxer = m_demuxers.findDemuxer(p->pid);
+
+        // announce it as soon as it is parsed
+        if(demuxer != nullptr && demuxer->isParsed()) {
+            m_requestStreamChange = true;
+        }
+    }
+
     // stream change needed / requested
     if(m_requestStreamChange && m_demuxers.isReady()) {
 
@@ -169,6 +182,20 @@ void StreamPacketProcessor::onStreamPacket(TsDemuxer::StreamPacket *p) {
         }
     }
 
+    // the client doesn't know this stream yet - drop packet
+    if(m_demuxers.isReady() && m_announcedPids.count(p->pid) == 0) {
+        return;
+    }
+
+    // it will only be announced if it is parsed
+    if(!m_demuxers.isReady()) {
+        TsDemuxer* demuxer = m_demuxers.findDemuxer(p->pid);
+
+        if(demuxer == nullptr || !demuxer->isParsed()) {
+            return;
+        }
+    }
+
     // initialise stream packet
     MsgPacket* packet = new MsgPacket(ROBOTV_STREAM_MUXPKT, ROBOTV_CHANNEL_STREAM);
     packet->disablePayloadCheckSum();
@@ -216,9 +243,25 @@ void StreamPacketProcessor::onStreamChange() {
 MsgPacket *StreamPacketProcessor::createStreamChangePacket(DemuxerBundle &bundle) {
     MsgPacket* resp = new MsgPacket(ROBOTV_STREAM_CHANGE, ROBOTV_CHANNEL_STREAM);
 
-    resp->put_U8((uint8_t)bundle.size());
+    // skip streams we do not know yet
+    // they will be sent with the next stream change
+    uint8_t count = 0;
+    m_announcedPids.clear();
+
+    for(auto stream: bundle) {
+        if(stream->isParsed()) {
+            m_announcedPids.insert(stream->getPid());
+            count++;
+        }
+    }
+
+    resp->put_U8(count);
 
     for(auto stream: bundle) {
+        if(!stream->isParsed()) {
+            continue;
+        }
+
         int streamId = stream->getPid();
         resp->put_U32((uint32_t)streamId);
 
@@ -246,27 +289,27 @@ MsgPacket *StreamPacketProcessor::createStreamChangePacket(DemuxerBundle &bundle
                     int length = 0;
 
                     // put SPS
-                    uint8_t* sps = stream->getVideoDecoderSps(length);
+                    const uint8_t* sps = stream->getVideoDecoderSps(length);
                     resp->put_U8((uint8_t)length);
 
                     if(sps != NULL) {
-                        resp->put_Blob(sps, (uint8_t)length);
+                        resp->put_Blob((uint8_t*)sps, (uint8_t)length);
                     }
 
                     // put PPS
-                    uint8_t* pps = stream->getVideoDecoderPps(length);
+                    const uint8_t* pps = stream->getVideoDecoderPps(length);
                     resp->put_U8((uint8_t)length);
 
                     if(pps != NULL) {
-                        resp->put_Blob(pps, (uint8_t)length);
+                        resp->put_Blob((uint8_t*)pps, (uint8_t)length);
                     }
 
                     // put VPS
-                    uint8_t* vps = stream->getVideoDecoderVps(length);
+                    const uint8_t* vps = stream->getVideoDecoderVps(length);
                     resp->put_U8((uint8_t)length);
 
-                    if(pps != NULL) {
-                        resp->put_Blob(vps, (uint8_t)length);
+                    if(vps != NULL) {
+                        resp->put_Blob((uint8_t*)vps, (uint8_t)length);
                     }
                 }
                 break;
@@ -293,7 +336,5 @@ MsgPacket *StreamPacketProcessor::createStreamChangePacket(DemuxerBundle &bundle
 void StreamPacketProcessor::flush() {
     isyslog("flushing pending packets");
 
-    for(auto& i : m_demuxers) {
-        i->flush();
-    }
+    m_demuxers.flush();
 }
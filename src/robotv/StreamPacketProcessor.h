@@ -31,6 +31,7 @@
 #include <net/msgpacket.h>
 #include <vdr/remux.h>
 #include <deque>
+#include <set>
 
 class StreamPacketProcessor : protected TsDemuxer::Listener {
 public:
@@ -104,6 +105,8 @@ private:
     bool m_requestStreamChange;
 
     std::deque<MsgPacket*> m_preQueue;
+
+    std::set<int> m_announcedPids;
 };
 
 
@@ -30,6 +30,7 @@
 #include "tools/recid2uid.h"
 #include "config/config.h"
 #include "recordings/recordingscache.h"
+#include "recordings/previews.h"
 #include "vdr/videodir.h"
 #include "vdr/menu.h"
 
@@ -71,6 +72,9 @@ MsgPacket* MovieController::process(MsgPacket* request) {
         case ROBOTV_RECORDINGS_SEARCH:
             return processSearch(request);
 
+        case ROBOTV_RECORDINGS_GETPREVIEWS:
+            return processGetPreviews(request);
+
         default:
             break;
     }
@@ -421,3 +425,49 @@ void MovieController::recordingToPacket(const cRecording* recording, MsgPacket*
     // icon url - for future use
     response->put_String((const char*)cache.getBackgroundUrl(uid));
 }
+
+MsgPacket* MovieController::processGetPreviews(MsgPacket* request) {
+    const char* recid = request->get_String();
+    uint32_t count = request->get_U32();
+    uint32_t uid = recid2uid(recid);
+
+    MsgPacket* response = createResponse(request);
+
+    if(count == 0 || count > 64) {
+        response->put_U32(ROBOTV_RET_DATAINVALID);
+        return response;
+    }
+
+    std::string fileName;
+    double framesPerSecond = 0;
+    bool isPesRecording = false;
+
+    // don't block the recordings while extracting the previews
+    {
+        LOCK_RECORDINGS_READ;
+        auto recording = RecordingsCache::instance().lookup(Recordings, uid);
+
+        if(recording == nullptr) {
+            esyslog("GetPreviews: recording not found !");
+            response->put_U32(ROBOTV_RET_DATAUNKNOWN);
+            return response;
+        }
+
+        fileName = recording->FileName();
+        framesPerSecond = recording->FramesPerSecond();
+        isPesRecording = recording->IsPesRecording();
+    }
+
+    MsgPacket* previews = Previews::get(fileName.c_str(), framesPerSecond, isPesRecording, uid, (int)count);
+
+    if(previews == nullptr) {
+        isyslog("no previews available for: '%s'", fileName.c_str());
+        response->put_U32(ROBOTV_RET_NOTSUPPORTED);
+        return response;
+    }
+
+    response->put_Blob(previews->getPayload(), previews->getPayloadLength());
+    delete previews;
+
+    return response;
+}
@@ -54,6 +54,9 @@ MsgPacket* RecordingController::process(MsgPacket* request) {
 
         case ROBOTV_RECSTREAM_PAUSE:
             return processPause(request);
+
+        case ROBOTV_RECSTREAM_TRICKPLAY:
+            return processTrickPlay(request);
     }
 
     return nullptr;
@@ -64,6 +67,9 @@ MsgPacket* RecordingController::processOpen(MsgPacket* request) {
     unsigned int uid = recid2uid(recid);
     dsyslog("lookup recid: %s (uid: %u)", recid, uid);
 
+    // optional - skip segments outside of the marks
+    bool skipMarks = !request->eop() && request->get_U8() != 0;
+
     LOCK_RECORDINGS_READ;
 
     auto recording = RecordingsCache::instance().lookup(Recordings, uid);
@@ -72,8 +78,9 @@ MsgPacket* RecordingController::processOpen(MsgPacket* request) {
     if(recording && m_recPlayer == NULL) {
         m_recPlayer = new PacketPlayer(recording);
 
-        delete m_recPlayer->requestPacket();
-        m_recPlayer->reset();
+        if(skipMarks) {
+            m_recPlayer->setSkipMarks(true);
+        }
 
         uint32_t length = (uint32_t)(m_recPlayer->endTime().count() - m_recPlayer->startTime().count()) / 1000;
 
@@ -137,3 +144,15 @@ MsgPacket* RecordingController::processPause(MsgPacket* request) {
 
     return createResponse(request);
 }
+
+MsgPacket* RecordingController::processTrickPlay(MsgPacket* request) {
+    if(m_recPlayer == nullptr) {
+        return nullptr;
+    }
+
+    int32_t speed = request->get_S32();
+
+    MsgPacket* response = createResponse(request);
+    response->put_U32(m_recPlayer->setTrickPlay(speed) ? ROBOTV_RET_OK : ROBOTV_RET_NOTSUPPORTED);
+    return response;
+}
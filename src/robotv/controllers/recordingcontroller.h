@@ -52,6 +52,8 @@ protected:
 
     MsgPacket* processPause(MsgPacket* request);
 
+    MsgPacket* processTrickPlay(MsgPacket* request);
+
 private:
 
     RecordingController(const RecordingController& orig);
@@ -61,6 +61,9 @@ MsgPacket* StreamController::process(MsgPacket* request) {
 
         case ROBOTV_CHANNELSTREAM_SEEK:
             return processSeek(request);
+
+        case ROBOTV_CHANNELSTREAM_SELECT:
+            return processSelect(request);
     }
 
     return nullptr;
@@ -225,3 +228,21 @@ MsgPacket* StreamController::processSeek(MsgPacket* request) {
     response->put_S64(pts);
     return response;
 }
+
+MsgPacket* StreamController::processSelect(MsgPacket* request) {
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    if(m_streamer == nullptr) {
+        return nullptr;
+    }
+
+    int pid = (int)request->get_U32();
+    bool enabled = (request->get_U8() != 0);
+
+    isyslog("%s stream (pid %i)", enabled ? "enabling" : "disabling", pid);
+    m_streamer->selectStream(pid, enabled);
+
+    MsgPacket* response = createResponse(request);
+    response->put_U32(ROBOTV_RET_OK);
+    return response;
+}
@@ -58,6 +58,8 @@ protected:
 
     MsgPacket* processSeek(MsgPacket* request);
 
+    MsgPacket* processSelect(MsgPacket* request);
+
 private:
 
     StreamController(const StreamController& orig);
@@ -25,6 +25,7 @@
 #include <getopt.h>
 #include <vdr/plugin.h>
 #include "robotv.h"
+#include "recordings/recordingscache.h"
 
 PluginRoboTVServer::PluginRoboTVServer(void) {
     m_server = NULL;
@@ -74,10 +75,14 @@ bool PluginRoboTVServer::Start(void) {
 void PluginRoboTVServer::Stop(void) {
     delete m_server;
     m_server = NULL;
+
+    // write pending recording metadata
+    RecordingsCache::instance().flush();
 }
 
 void PluginRoboTVServer::Housekeeping(void) {
-    // Perform any cleanup or other regular tasks.
+    // write modified recording metadata
+    RecordingsCache::instance().flush();
 }
 
 void PluginRoboTVServer::MainThreadHook(void) {
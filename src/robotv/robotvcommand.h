@@ -53,6 +53,7 @@
 #define ROBOTV_CHANNELSTREAM_PAUSE   23
 #define ROBOTV_CHANNELSTREAM_SIGNAL  24
 #define ROBOTV_CHANNELSTREAM_SEEK    25
+#define ROBOTV_CHANNELSTREAM_SELECT  26
 
 /* OPCODE 40 - 59: RoboTV network functions for recording streaming */
 #define ROBOTV_RECSTREAM_OPEN        40
@@ -60,6 +61,7 @@
 #define ROBOTV_RECSTREAM_REQUEST     22 // same id as for channelstream
 #define ROBOTV_RECSTREAM_PAUSE       23 // same id as for channelstream
 #define ROBOTV_RECSTREAM_SEEK        25 // same id as for channelstream
+#define ROBOTV_RECSTREAM_TRICKPLAY   42
 
 /* OPCODE 60 - 79: RoboTV network functions for channel access */
 #define ROBOTV_CHANNELS_GETCOUNT     61
@@ -91,6 +93,7 @@
 #define ROBOTV_RECORDINGS_GETMARKS     108
 #define ROBOTV_RECORDINGS_SETURLS      109
 #define ROBOTV_RECORDINGS_SEARCH       112
+#define ROBOTV_RECORDINGS_GETPREVIEWS  113
 
 #define ROBOTV_ARTWORK_SET             110
 #define ROBOTV_ARTWORK_GET             111